@@ -1,6 +1,7 @@
 #pragma once
 #include <iomanip>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "zone.hh"
@@ -74,6 +75,42 @@ public:
 
 template <class T> using AnsNum = AnsContainer<IntContainer<T>>;
 
+/*!
+  @brief A pseudo-container class to write the given zones to an array owned
+  by the caller. This is given to @link AnsContainer @endlink.
+
+  @note The zones after the capacity are not written but counted.
+ */
+class BufferContainer {
+private:
+  Zone *first = nullptr;
+  std::size_t capacity = 0;
+  std::size_t count = 0;
+
+public:
+  /*!
+    @param [in] first The pointer to the first element of the array
+    @param [in] capacity The number of the elements of the array
+   */
+  BufferContainer(Zone *first, std::size_t capacity)
+      : first(first), capacity(capacity) {}
+  //! @brief Returns the count of output zones including the ones not written.
+  std::size_t size() const { return count; }
+  void push_back(const Zone &ans) {
+    if (count < capacity) {
+      first[count] = ans;
+    }
+    count++;
+  }
+  //! @brief Resets the count of output zones.
+  void clear() { count = 0; }
+  //! @brief Does nothing.
+  void reserve(std::size_t) {}
+  using value_type = Zone;
+};
+
+using AnsBuffer = AnsContainer<BufferContainer>;
+
 /*!
   @brief A pseudo-container class to print the given zone to stdout. This is
   given to @link AnsContainer @endlink.
@@ -85,6 +122,8 @@ class PrintContainer {
 private:
   std::size_t count = 0;
   bool isQuiet = false;
+  //! @brief The line printed before each zone. If it is empty, nothing is printed.
+  std::string tag;
 
 public:
   /*!
@@ -93,11 +132,30 @@ public:
     @param [in] isQuiet If isQuiet is true, this class does not print anything.
   */
   PrintContainer(bool isQuiet) : isQuiet(isQuiet) {}
+  /*!
+    @brief Constructor for one of many patterns. Each zone is preceded by the line "pattern: patternID".
+
+    @param [in] isQuiet If isQuiet is true, this class does not print anything.
+    @param [in] patternID The ID of the pattern printed with the zones.
+  */
+  PrintContainer(bool isQuiet, std::size_t patternID)
+      : isQuiet(isQuiet), tag("pattern: " + std::to_string(patternID)) {}
+  /*!
+    @brief Constructor with a tag. Each zone is preceded by the line tag.
+
+    @param [in] isQuiet If isQuiet is true, this class does not print anything.
+    @param [in] tag The line printed with the zones, e.g., "key: car1".
+  */
+  PrintContainer(bool isQuiet, std::string tag)
+      : isQuiet(isQuiet), tag(std::move(tag)) {}
   //! @brief Returns the count of output zones.
   std::size_t size() const { return count; }
   void push_back(const Zone &ans) {
     count++;
     if (!isQuiet) {
+      if (!tag.empty()) {
+        puts(tag.c_str());
+      }
       printf("%10lf %8s t %s %10lf\n", -ans.value(0, 1).first,
              (ans.value(0, 1).second ? "<=" : "<"),
              (ans.value(1, 0).second ? "<=" : "<"), ans.value(1, 0).first);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ans_vec.hh"
+#include "compiled_pattern.hh"
+#include "monaa.hh"
+#include "word_container.hh"
+
+/*!
+  @file batch_monaa.hh
+  @brief Timed pattern matching of a timed word in memory stored in columns
+ */
+
+/*!
+  @brief Execute the timed FJS algorithm over the arrays of the labels and the timestamps
+
+  The i-th event is labelled with events[i] at timestamps[i]. The arrays are read in place through @link WordColumns
+  @endlink, and the events are not copied. The algorithm is chosen by the mode of the pattern.
+
+  @param [in] events The array of the labels of the events.
+  @param [in] timestamps The array of the timestamps of the events.
+  @param [in] size The number of the events.
+  @param [in] pattern A pattern compiled in advance.
+  @param [out] ans A container for the answer zones.
+ */
+template <class OutputContainer>
+void batchMonaa(const Alphabet *events, const double *timestamps, std::size_t size, const CompiledPattern &pattern,
+                AnsContainer<OutputContainer> &ans) {
+  if (pattern.mode == CompiledPattern::Mode::signal) {
+    monaa(WordColumns(events, timestamps, size), pattern, ans);
+  } else {
+    monaaDollar(WordColumns(events, timestamps, size), pattern, ans);
+  }
+}
+
+/*!
+  @brief Execute the timed FJS algorithm over the arrays of the labels and the timestamps, and write the answer zones
+  to an array owned by the caller
+
+  @param [in] events The array of the labels of the events.
+  @param [in] timestamps The array of the timestamps of the events.
+  @param [in] size The number of the events.
+  @param [in] pattern A pattern compiled in advance.
+  @param [out] matches The array for the answer zones. Only the first capacity zones are written.
+  @param [in] capacity The number of the elements of matches.
+  @returns The number of all the answer zones. If it is larger than capacity, the caller can retry with a larger array.
+ */
+inline std::size_t batchMonaa(const Alphabet *events, const double *timestamps, std::size_t size,
+                              const CompiledPattern &pattern, Zone *matches, std::size_t capacity) {
+  AnsBuffer ans(BufferContainer(matches, capacity));
+  batchMonaa(events, timestamps, size, pattern, ans);
+  return ans.size();
+}
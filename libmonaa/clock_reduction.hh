@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "timed_automaton.hh"
+
+/*!
+  @brief The numbers of the clock variables before and after the clock reduction
+ */
+struct ClockReduction {
+  std::size_t before;
+  std::size_t after;
+};
+
+/*!
+  @brief Rename the clock variables of TA
+
+  @param [in] rename The new name of each clock variable. The clock variables renamed to maxConstraints.size() are
+  removed. They must not be used in any guard.
+  @param [in] maxConstraints The maximum constants of the new clock variables
+ */
+inline void renameClocks(TimedAutomaton &TA, const std::vector<std::size_t> &rename, std::vector<int> maxConstraints) {
+  const std::size_t removed = maxConstraints.size();
+  for (const auto &state : TA.states) {
+    for (auto &edges : state->next) {
+      for (auto &edge : edges.second) {
+        for (auto &constraint : edge.guard) {
+          constraint.x = rename[constraint.x];
+        }
+        std::vector<ClockVariables> resetVars;
+        resetVars.reserve(edge.resetVars.size());
+        for (ClockVariables x : edge.resetVars) {
+          if (rename[x] != removed &&
+              std::find(resetVars.begin(), resetVars.end(), rename[x]) == resetVars.end()) {
+            resetVars.push_back(rename[x]);
+          }
+        }
+        edge.resetVars = std::move(resetVars);
+      }
+    }
+  }
+  TA.maxConstraints = std::move(maxConstraints);
+}
+
+/*!
+  @brief Remove the inactive clock variables and merge the equal ones and the ones never live at the same time
+
+  A clock variable is inactive if it is not used in any guard. Two clock variables are always equal if they are reset
+  by exactly the same transitions because all the clock variables are zero at the beginning of a matching. We remove
+  the inactive clock variables and rename the equal clock variables to one of them.
+
+  Then, we merge the clock variables by their liveness. A clock variable is live at a state if a guard reachable from
+  the state reads it before it is reset. Two clock variables x and y interfere if they are live at the same state, or
+  a transition resets x but not y and y is live at its target. Otherwise, each of them is dead wherever the other one
+  is live or reset, and we greedily rename the clock variables not interfering with each other to one of them.
+
+  @note The transitions of TA are modified in place. Make a deep copy if the states are shared with another automaton.
+  @returns The numbers of the clock variables before and after the reduction
+ */
+inline ClockReduction reduceClocks(TimedAutomaton &TA) {
+  const std::size_t before = TA.clockSize();
+  std::vector<bool> isActive(before, false);
+  // The indices of the transitions resetting each clock variable
+  std::vector<std::vector<std::size_t>> resetTransitions(before);
+  std::size_t transitionIndex = 0;
+  for (const auto &state : TA.states) {
+    for (const auto &edges : state->next) {
+      for (const auto &edge : edges.second) {
+        for (const auto &constraint : edge.guard) {
+          isActive.at(constraint.x) = true;
+        }
+        for (ClockVariables x : edge.resetVars) {
+          if (resetTransitions.at(x).empty() || resetTransitions.at(x).back() != transitionIndex) {
+            resetTransitions.at(x).push_back(transitionIndex);
+          }
+        }
+        transitionIndex++;
+      }
+    }
+  }
+
+  // The new name of each clock variable. The inactive clock variables are mapped to the number of the new ones.
+  std::vector<std::size_t> rename(before);
+  std::map<std::vector<std::size_t>, std::size_t> toNewClock;
+  std::vector<int> maxConstraints;
+  for (std::size_t x = 0; x < before; ++x) {
+    if (!isActive[x]) {
+      continue;
+    }
+    auto it = toNewClock.find(resetTransitions[x]);
+    if (it == toNewClock.end()) {
+      it = toNewClock.emplace(resetTransitions[x], maxConstraints.size()).first;
+      maxConstraints.push_back(TA.maxConstraints[x]);
+    } else {
+      maxConstraints[it->second] = std::max(maxConstraints[it->second], TA.maxConstraints[x]);
+    }
+    rename[x] = it->second;
+  }
+  std::size_t after = maxConstraints.size();
+  for (std::size_t x = 0; x < before; ++x) {
+    if (!isActive[x]) {
+      rename[x] = after;
+    }
+  }
+  // Since the renaming is monotonic, it is the identity if no clock variable is removed.
+  if (after != before) {
+    renameClocks(TA, rename, std::move(maxConstraints));
+  }
+
+  // The clock variables live at each state, i.e., the least fixed point of
+  // live(q) = the union of guard(e) and live(target(e)) \ reset(e) for the transitions e from q
+  std::unordered_map<const TAState *, std::size_t> toIndex;
+  toIndex.reserve(TA.stateSize());
+  for (std::size_t i = 0; i < TA.stateSize(); ++i) {
+    toIndex[TA.states[i].get()] = i;
+  }
+  std::vector<std::vector<bool>> isLive(TA.stateSize(), std::vector<bool>(after, false));
+  for (bool isChanged = true; isChanged;) {
+    isChanged = false;
+    for (std::size_t i = 0; i < TA.stateSize(); ++i) {
+      std::vector<bool> live(after, false);
+      for (const auto &edges : TA.states[i]->next) {
+        for (const auto &edge : edges.second) {
+          for (const auto &constraint : edge.guard) {
+            live[constraint.x] = true;
+          }
+          if (!edge.target) {
+            continue;
+          }
+          const auto &targetLive = isLive[toIndex.at(edge.target)];
+          for (std::size_t x = 0; x < after; ++x) {
+            if (targetLive[x] &&
+                std::find(edge.resetVars.begin(), edge.resetVars.end(), x) == edge.resetVars.end()) {
+              live[x] = true;
+            }
+          }
+        }
+      }
+      if (live != isLive[i]) {
+        isLive[i] = std::move(live);
+        isChanged = true;
+      }
+    }
+  }
+
+  std::vector<std::vector<bool>> interferes(after, std::vector<bool>(after, false));
+  for (std::size_t i = 0; i < TA.stateSize(); ++i) {
+    for (std::size_t x = 0; x < after; ++x) {
+      for (std::size_t y = 0; y < after; ++y) {
+        if (isLive[i][x] && isLive[i][y]) {
+          interferes[x][y] = true;
+        }
+      }
+    }
+    for (const auto &edges : TA.states[i]->next) {
+      for (const auto &edge : edges.second) {
+        if (!edge.target) {
+          continue;
+        }
+        const auto &targetLive = isLive[toIndex.at(edge.target)];
+        for (ClockVariables x : edge.resetVars) {
+          for (std::size_t y = 0; y < after; ++y) {
+            if (targetLive[y] && std::find(edge.resetVars.begin(), edge.resetVars.end(), y) == edge.resetVars.end()) {
+              interferes[x][y] = interferes[y][x] = true;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // The clock variables merged into each new clock variable
+  std::vector<std::vector<std::size_t>> groups;
+  std::vector<std::size_t> liveRename(after);
+  maxConstraints.clear();
+  for (std::size_t x = 0; x < after; ++x) {
+    auto it = std::find_if(groups.begin(), groups.end(), [&](const std::vector<std::size_t> &group) {
+      return std::none_of(group.begin(), group.end(), [&](std::size_t y) { return interferes[x][y]; });
+    });
+    if (it == groups.end()) {
+      groups.emplace_back();
+      maxConstraints.push_back(TA.maxConstraints[x]);
+      it = std::prev(groups.end());
+    } else {
+      maxConstraints[it - groups.begin()] = std::max(maxConstraints[it - groups.begin()], TA.maxConstraints[x]);
+    }
+    it->push_back(x);
+    liveRename[x] = it - groups.begin();
+  }
+  if (groups.size() != after) {
+    after = groups.size();
+    renameClocks(TA, liveRename, std::move(maxConstraints));
+  }
+
+  return {before, after};
+}
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compiled_pattern.hh"
+#include "indexed_timed_automaton.hh"
+
+namespace {
+  constexpr char magic[8] = {'M', 'O', 'N', 'A', 'A', 'P', 'A', 'T'};
+  constexpr std::uint32_t version = 1;
+  //! @brief The index representing the null target of a transition
+  constexpr std::uint64_t nullIndex = std::numeric_limits<std::uint64_t>::max();
+
+  class Writer {
+  public:
+    explicit Writer(std::ostream &os) : os(os) {}
+    template <class T> void write(const T &value) {
+      os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+    template <class T> void writeArray(const T *values, std::size_t size) {
+      os.write(reinterpret_cast<const char *>(values), sizeof(T) * size);
+    }
+
+  private:
+    std::ostream &os;
+  };
+
+  //! @brief Read the values from a memory region, e.g., a mapped file, with the bound check
+  class Reader {
+  public:
+    Reader(const char *begin, const char *end) : current(begin), end(end) {}
+    //! @brief Returns true if all the bytes are read
+    bool atEnd() const { return current == end; }
+    template <class T> T read() {
+      T value;
+      readArray(&value, 1);
+      return value;
+    }
+    template <class T> void readArray(T *values, std::size_t size) {
+      if (size == 0) {
+        return;
+      }
+      if (size > static_cast<std::size_t>(end - current) / sizeof(T)) {
+        throw std::runtime_error("truncated compiled pattern");
+      }
+      std::memcpy(values, current, sizeof(T) * size);
+      current += sizeof(T) * size;
+    }
+
+  private:
+    const char *current;
+    const char *end;
+  };
+
+  //! @brief Throw if a value read from a compiled pattern is out of its range
+  void ensure(bool isValid) {
+    if (!isValid) {
+      throw std::runtime_error("broken compiled pattern");
+    }
+  }
+
+  //! @brief A read-only mapping of a file
+  class MappedFile {
+  public:
+    explicit MappedFile(const std::string &fileName) {
+      const int fd = open(fileName.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw std::runtime_error("failed to open " + fileName);
+      }
+      struct stat st {};
+      if (fstat(fd, &st) < 0) {
+        close(fd);
+        throw std::runtime_error("failed to stat " + fileName);
+      }
+      size = st.st_size;
+      if (size > 0) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      }
+      close(fd);
+      if (data == MAP_FAILED) {
+        throw std::runtime_error("failed to map " + fileName);
+      }
+    }
+    ~MappedFile() {
+      if (data && data != MAP_FAILED) {
+        munmap(data, size);
+      }
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *begin() const { return static_cast<const char *>(data); }
+    const char *end() const { return begin() + size; }
+
+  private:
+    void *data = nullptr;
+    std::size_t size = 0;
+  };
+
+  void writeCompiledPattern(const CompiledPattern &pattern, std::ostream &os) {
+    Writer writer(os);
+    const IndexedTimedAutomaton A(pattern.automaton);
+
+    // header
+    writer.writeArray(magic, sizeof(magic));
+    writer.write(version);
+    writer.write(static_cast<std::uint32_t>(pattern.mode));
+    writer.write(static_cast<std::uint64_t>(A.stateSize()));
+    writer.write(static_cast<std::uint64_t>(A.initialStates.size()));
+    writer.write(static_cast<std::uint64_t>(A.maxConstraints.size()));
+    writer.write(static_cast<std::uint64_t>(A.transitions.size()));
+
+    // timed automaton
+    for (int c : A.maxConstraints) {
+      writer.write(static_cast<std::int32_t>(c));
+    }
+    for (const auto &state : A.states) {
+      writer.write(static_cast<std::uint8_t>(state.isMatch | (state.zeroDuration << 1)));
+    }
+    for (std::size_t i : A.initialStates) {
+      writer.write(static_cast<std::uint64_t>(i));
+    }
+    for (std::size_t i = 0; i < A.stateSize(); ++i) {
+      for (std::size_t k = A.transitionBegin[i]; k < A.transitionBegin[i + 1]; ++k) {
+        const auto &transition = A.transitions[k];
+        writer.write(static_cast<std::uint64_t>(i));
+        writer.write(transition.target == IndexedTimedAutomaton::nullIndex ? nullIndex
+                                                                            : static_cast<std::uint64_t>(transition.target));
+        writer.write(static_cast<std::int32_t>(transition.c));
+        writer.write(static_cast<std::uint32_t>(transition.resetEnd - transition.resetBegin));
+        writer.write(static_cast<std::uint32_t>(transition.guardEnd - transition.guardBegin));
+        for (std::uint32_t j = transition.resetBegin; j < transition.resetEnd; ++j) {
+          writer.write(static_cast<std::uint32_t>(A.resetVars[j]));
+        }
+        for (std::uint32_t j = transition.guardBegin; j < transition.guardEnd; ++j) {
+          const Constraint &constraint = A.guards[j];
+          writer.write(static_cast<std::uint32_t>(constraint.x));
+          writer.write(static_cast<std::int32_t>(constraint.odr));
+          writer.write(static_cast<std::int32_t>(constraint.c));
+        }
+      }
+    }
+
+    // Sunday's skip value
+    const SundaySkipValue &delta = pattern.delta;
+    writer.write(static_cast<std::int32_t>(delta.getM()));
+    writer.write(static_cast<std::uint32_t>(delta.useQGram()));
+    writer.write(delta.getExpectedShift());
+    writer.writeArray(delta.getDelta().data(), delta.getDelta().size());
+    writer.writeArray(delta.getEndCharMask().data(), delta.getEndCharMask().size());
+    writer.write(static_cast<std::uint64_t>(delta.getQGramDelta().size()));
+    writer.writeArray(delta.getQGramDelta().data(), delta.getQGramDelta().size());
+
+    // KMP-type skip value
+    for (const auto &state : pattern.automaton.states) {
+      writer.write(static_cast<std::int32_t>(pattern.beta[state]));
+    }
+
+    // duration
+    writer.write(pattern.duration.getMin());
+    writer.write(pattern.duration.getMax());
+  }
+} // namespace
+
+void saveCompiledPattern(const CompiledPattern &pattern, const std::string &fileName) {
+  std::ofstream ofs(fileName, std::ios::binary | std::ios::trunc);
+  if (!ofs) {
+    throw std::runtime_error("failed to open " + fileName);
+  }
+  writeCompiledPattern(pattern, ofs);
+  if (!ofs) {
+    throw std::runtime_error("failed to write " + fileName);
+  }
+}
+
+std::uint64_t CompiledPattern::computeFingerprint(const CompiledPattern &pattern) {
+  std::ostringstream os;
+  writeCompiledPattern(pattern, os);
+  // 64-bit FNV-1a
+  std::uint64_t hash = 0xcbf29ce484222325;
+  for (const char c : os.view()) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+std::unique_ptr<CompiledPattern> loadCompiledPattern(const std::string &fileName) {
+  const MappedFile file(fileName);
+  Reader reader(file.begin(), file.end());
+
+  // header
+  char fileMagic[sizeof(magic)];
+  reader.readArray(fileMagic, sizeof(fileMagic));
+  if (std::memcmp(fileMagic, magic, sizeof(magic)) != 0) {
+    throw std::runtime_error(fileName + " is not a compiled pattern");
+  }
+  if (reader.read<std::uint32_t>() != version) {
+    throw std::runtime_error("unsupported version of compiled pattern");
+  }
+  const auto mode = static_cast<CompiledPattern::Mode>(reader.read<std::uint32_t>());
+  if (mode != CompiledPattern::Mode::event && mode != CompiledPattern::Mode::signal) {
+    throw std::runtime_error("unknown mode of compiled pattern");
+  }
+  const auto stateSize = reader.read<std::uint64_t>();
+  const auto initialStateSize = reader.read<std::uint64_t>();
+  const auto clockSize = reader.read<std::uint64_t>();
+  const auto transitionSize = reader.read<std::uint64_t>();
+  // Each element takes at least one byte
+  const auto fileSize = static_cast<std::uint64_t>(file.end() - file.begin());
+  ensure(stateSize <= fileSize && initialStateSize <= fileSize && clockSize <= fileSize && transitionSize <= fileSize);
+  const auto at = [stateSize](std::uint64_t index) {
+    ensure(index < stateSize);
+    return index;
+  };
+  const auto clockAt = [clockSize](std::uint32_t x) {
+    ensure(x < clockSize);
+    return static_cast<ClockVariables>(x);
+  };
+
+  // timed automaton
+  TimedAutomaton A;
+  A.maxConstraints.resize(clockSize);
+  for (auto &c : A.maxConstraints) {
+    c = reader.read<std::int32_t>();
+  }
+  A.states.reserve(stateSize);
+  for (std::uint64_t i = 0; i < stateSize; ++i) {
+    const auto flags = reader.read<std::uint8_t>();
+    A.states.push_back(std::make_shared<TAState>(flags & 1));
+    A.states.back()->zeroDuration = flags & 2;
+  }
+  A.initialStates.reserve(initialStateSize);
+  for (std::uint64_t i = 0; i < initialStateSize; ++i) {
+    A.initialStates.push_back(A.states[at(reader.read<std::uint64_t>())]);
+  }
+  for (std::uint64_t i = 0; i < transitionSize; ++i) {
+    const auto source = at(reader.read<std::uint64_t>());
+    const auto target = reader.read<std::uint64_t>();
+    const auto c = static_cast<Alphabet>(reader.read<std::int32_t>());
+    const auto resetSize = reader.read<std::uint32_t>();
+    const auto guardSize = reader.read<std::uint32_t>();
+    TATransition transition;
+    transition.target = target == nullIndex ? nullptr : A.states[at(target)].get();
+    transition.resetVars.reserve(resetSize);
+    for (std::uint32_t j = 0; j < resetSize; ++j) {
+      transition.resetVars.push_back(clockAt(reader.read<std::uint32_t>()));
+    }
+    transition.guard.reserve(guardSize);
+    for (std::uint32_t j = 0; j < guardSize; ++j) {
+      Constraint constraint;
+      constraint.x = clockAt(reader.read<std::uint32_t>());
+      const auto odr = reader.read<std::int32_t>();
+      ensure(odr >= static_cast<std::int32_t>(Constraint::Order::lt) &&
+             odr <= static_cast<std::int32_t>(Constraint::Order::gt));
+      constraint.odr = static_cast<Constraint::Order>(odr);
+      constraint.c = reader.read<std::int32_t>();
+      transition.guard.push_back(constraint);
+    }
+    A.states[source]->next[c].push_back(std::move(transition));
+  }
+
+  // Sunday's skip value
+  // A zero shift makes the Sunday's shift loop forever, and a shift longer than m + 1 (m + 2 for the q-gram one) may
+  // skip a matching. A character is an end character if and only if its shift is 1.
+  const auto m = reader.read<std::int32_t>();
+  ensure(m >= 1);
+  const auto maxShift = static_cast<std::int64_t>(m) + 1;
+  const bool isQGram = reader.read<std::uint32_t>();
+  const auto expectedShift = reader.read<double>();
+  std::array<unsigned int, UCHAR_MAX + 1> delta{};
+  reader.readArray(delta.data(), delta.size());
+  ensure(std::all_of(delta.begin(), delta.end(), [maxShift](unsigned int shift) {
+    return shift >= 1 && shift <= maxShift;
+  }));
+  std::array<std::uint64_t, 4> endCharMask{};
+  reader.readArray(endCharMask.data(), endCharMask.size());
+  const auto isEndChar = [&endCharMask](std::size_t c) { return (endCharMask[c >> 6] >> (c & 63)) & 1; };
+  for (std::size_t c = 0; c < delta.size(); ++c) {
+    ensure(bool(isEndChar(c)) == (delta[c] == 1));
+  }
+  const auto qGramSize = reader.read<std::uint64_t>();
+  ensure(qGramSize == (isQGram ? (UCHAR_MAX + 1) * (UCHAR_MAX + 1) : 0));
+  std::vector<unsigned int> qGramDelta(qGramSize);
+  reader.readArray(qGramDelta.data(), qGramDelta.size());
+  for (std::size_t k = 0; k < qGramDelta.size(); ++k) {
+    ensure(qGramDelta[k] >= 1 && qGramDelta[k] <= maxShift + 1);
+    ensure(bool(isEndChar(k / (UCHAR_MAX + 1))) == (qGramDelta[k] == 1));
+  }
+
+  // KMP-type skip value
+  // A shift longer than m + 1 may skip a matching.
+  std::unordered_map<const TAState *, int> beta;
+  beta.reserve(stateSize);
+  for (const auto &state : A.states) {
+    const auto shift = reader.read<std::int32_t>();
+    ensure(shift >= 1 && shift <= maxShift);
+    beta[state.get()] = shift;
+  }
+
+  // duration
+  const auto minDuration = reader.read<double>();
+  const auto maxDuration = reader.read<double>();
+  ensure(reader.atEnd());
+
+  return std::make_unique<CompiledPattern>(
+      mode, std::move(A), SundaySkipValue(m, delta, endCharMask, std::move(qGramDelta), isQGram, expectedShift),
+      KMPSkipValue(std::move(beta)), MatchDuration(minDuration, maxDuration));
+}
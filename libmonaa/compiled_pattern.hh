@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "clock_reduction.hh"
+#include "indexed_timed_automaton.hh"
+#include "kmp_skip_value.hh"
+#include "match_duration.hh"
+#include "sunday_skip_value.hh"
+#include "timed_automaton.hh"
+
+/*!
+ * @brief A pattern compiled for the timed FJS algorithm
+ *
+ * This bundles the timed automaton used in the matching and everything precomputed from it, i.e., the skip values of
+ * Sunday's quick search and KMP, and the bounds of the duration of the matchings. A compiled pattern can be saved to a
+ * file by saveCompiledPattern() and loaded by loadCompiledPattern() so that we can skip the precomputation.
+ */
+struct CompiledPattern {
+  //! @brief How the log is interpreted
+  enum class Mode : std::uint32_t {
+    //! @brief The log is a sequence of events. The accepting transitions are labelled with '$'. See monaaDollar.
+    event = 0,
+    //! @brief The log is a signal. See monaa.
+    signal = 1
+  };
+
+  Mode mode;
+  //! @brief The timed automaton used in the matching
+  TimedAutomaton automaton;
+  //! @brief Sunday's skip value
+  SundaySkipValue delta;
+  //! @brief KMP-type skip value indexed by the states of automaton
+  KMPSkipValue beta;
+  //! @brief The bounds of the duration of the matchings
+  MatchDuration duration;
+  //! @brief The numbers of the clock variables before and after the clock reduction
+  ClockReduction clocks;
+
+  /*!
+   * @brief Compile a timed automaton
+   *
+   * We reduce the clock variables of a deep copy of A before constructing the skip values. A itself is not modified.
+   *
+   * @param [in] A A timed automaton used as a pattern.
+   * @param [in] mode How the log is interpreted
+   */
+  CompiledPattern(const TimedAutomaton &A, Mode mode) : CompiledPattern(mode, ReducedAutomaton(A)) {}
+
+  //! @brief Restore a pattern compiled in advance
+  CompiledPattern(Mode mode, TimedAutomaton automaton, SundaySkipValue delta, KMPSkipValue beta,
+                  MatchDuration duration)
+      : mode(mode), automaton(std::move(automaton)), delta(std::move(delta)), beta(std::move(beta)),
+        duration(std::move(duration)), clocks{this->automaton.clockSize(), this->automaton.clockSize()},
+        fingerprintValue(computeFingerprint(*this)) {}
+
+private:
+  //! @brief The value of fingerprint(), computed once at the construction
+  std::uint64_t fingerprintValue;
+  friend std::uint64_t fingerprint(const CompiledPattern &pattern);
+  //! @brief Returns the 64-bit FNV-1a hash of the pattern in the format of saveCompiledPattern
+  static std::uint64_t computeFingerprint(const CompiledPattern &pattern);
+
+  //! @brief A deep copy of a timed automaton with the reduced clock variables
+  struct ReducedAutomaton {
+    TimedAutomaton automaton;
+    ClockReduction clocks;
+    explicit ReducedAutomaton(const TimedAutomaton &A) {
+      IndexedTimedAutomaton(A).toTimedAutomaton(automaton);
+      clocks = reduceClocks(automaton);
+    }
+  };
+
+  /*!
+   * @brief Make the sources of the transitions labelled with '$' accepting, and remove such transitions.
+   *
+   * The i-th state of the result corresponds to the i-th state of A.
+   */
+  static TimedAutomaton removeDollar(const TimedAutomaton &A) {
+    IndexedTimedAutomaton indexed(A);
+    for (std::size_t i = 0; i < indexed.stateSize(); ++i) {
+      for (std::size_t k = indexed.transitionBegin[i]; k < indexed.transitionBegin[i + 1]; ++k) {
+        if (indexed.transitions[k].c == '$') {
+          indexed.states[i].isMatch = true;
+        }
+      }
+    }
+    indexed.eraseTransitions([](std::size_t, const IndexedTimedAutomaton::Transition &transition) {
+      return transition.c == '$';
+    });
+    TimedAutomaton result;
+    indexed.toTimedAutomaton(result);
+    return result;
+  }
+
+  //! @brief Index the skip values by the states of A. The i-th state of skipAutomaton corresponds to the i-th state of A.
+  static KMPSkipValue toOriginal(const KMPSkipValue &beta, const TimedAutomaton &A,
+                                 const TimedAutomaton &skipAutomaton) {
+    std::unordered_map<const TAState *, int> result;
+    result.reserve(A.stateSize());
+    for (std::size_t i = 0; i < A.stateSize(); ++i) {
+      result[A.states[i].get()] = beta[skipAutomaton.states[i]];
+    }
+    return KMPSkipValue(std::move(result), beta.getConstructionTime(), beta.getTa2zaTime());
+  }
+
+  //! @brief In the signal mode, we compute the skip values with the original automaton.
+  CompiledPattern(Mode mode, const ReducedAutomaton &reduced)
+      : CompiledPattern(mode, reduced, mode == Mode::event ? removeDollar(reduced.automaton) : reduced.automaton) {}
+
+  CompiledPattern(Mode mode, const ReducedAutomaton &reduced, const TimedAutomaton &skipAutomaton)
+      : mode(mode), automaton(reduced.automaton), delta(skipAutomaton),
+        beta(toOriginal(KMPSkipValue(skipAutomaton, delta.getM()), reduced.automaton, skipAutomaton)),
+        duration(automaton), clocks(reduced.clocks), fingerprintValue(computeFingerprint(*this)) {}
+};
+
+/*!
+ * @brief Save a compiled pattern to a file
+ *
+ * The file starts with the magic "MONAAPAT" and the version of the format, followed by the timed automaton, the skip
+ * values, and the bounds of the duration. All the values are stored in fixed-width native byte order so that the
+ * loader can read the mapped file directly.
+ *
+ * @throws std::runtime_error if the file cannot be written
+ */
+void saveCompiledPattern(const CompiledPattern &pattern, const std::string &fileName);
+
+/*!
+ * @brief Returns the 64-bit FNV-1a hash of the compiled pattern in the format of saveCompiledPattern
+ *
+ * The hash covers the timed automaton, the skip values, and the bounds of the duration. It is used to check that a
+ * checkpoint of @link OnlineMonitor @endlink is restored with the same pattern.
+ *
+ * @note The hash is computed when the pattern is constructed or loaded, and it does not follow the later changes of
+ * the members of the pattern.
+ */
+inline std::uint64_t fingerprint(const CompiledPattern &pattern) { return pattern.fingerprintValue; }
+
+/*!
+ * @brief Load a compiled pattern saved by saveCompiledPattern
+ *
+ * @throws std::runtime_error if the file cannot be read or is not a compiled pattern of the supported version
+ */
+std::unique_ptr<CompiledPattern> loadCompiledPattern(const std::string &fileName);
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "timed_automaton.hh"
+
+/*!
+  @brief A timed automaton stored in contiguous arrays addressed by indices
+
+  The states are identified by their indices in TimedAutomaton::states. The transitions from the i-th state are
+  transitions[transitionBegin[i]] ... transitions[transitionBegin[i + 1] - 1], and the reset variables and the guards
+  of the transitions are pooled in resetVars and guards, respectively. Since it contains no pointer, a copy is just a
+  copy of the arrays, and rewriting the automaton does not need any mapping between the states of the copies.
+ */
+struct IndexedTimedAutomaton {
+  //! @brief The index representing the null target of a transition
+  static constexpr std::size_t nullIndex = std::numeric_limits<std::size_t>::max();
+
+  struct State {
+    bool isMatch;
+    bool zeroDuration;
+  };
+
+  struct Transition {
+    Alphabet c;
+    //! @brief The index of the target state, or nullIndex
+    std::size_t target;
+    //! @brief The reset variables are resetVars[resetBegin] ... resetVars[resetEnd - 1]
+    std::uint32_t resetBegin, resetEnd;
+    //! @brief The guard is guards[guardBegin] ... guards[guardEnd - 1]
+    std::uint32_t guardBegin, guardEnd;
+  };
+
+  std::vector<State> states;
+  std::vector<std::size_t> initialStates;
+  //! @brief The offsets of the transitions of each state. The size is states.size() + 1.
+  std::vector<std::size_t> transitionBegin = {0};
+  std::vector<Transition> transitions;
+  std::vector<ClockVariables> resetVars;
+  std::vector<Constraint> guards;
+  std::vector<int> maxConstraints;
+
+  IndexedTimedAutomaton() = default;
+
+  //! @brief Make the indexed representation of TA. The i-th state corresponds to TA.states[i].
+  explicit IndexedTimedAutomaton(const TimedAutomaton &TA) : maxConstraints(TA.maxConstraints) {
+    std::unordered_map<const TAState *, std::size_t> toIndex;
+    toIndex.reserve(TA.stateSize());
+    states.reserve(TA.stateSize());
+    transitionBegin.reserve(TA.stateSize() + 1);
+    for (std::size_t i = 0; i < TA.stateSize(); ++i) {
+      toIndex[TA.states[i].get()] = i;
+      states.push_back({TA.states[i]->isMatch, TA.states[i]->zeroDuration});
+    }
+    initialStates.reserve(TA.initialStates.size());
+    for (const auto &state : TA.initialStates) {
+      initialStates.push_back(toIndex.at(state.get()));
+    }
+    std::vector<Alphabet> labels;
+    for (const auto &state : TA.states) {
+      // The transitions are sorted by the labels so that the result does not depend on the order in the hash table.
+      labels.clear();
+      for (const auto &edges : state->next) {
+        labels.push_back(edges.first);
+      }
+      std::sort(labels.begin(), labels.end());
+      for (const Alphabet c : labels) {
+        for (const auto &edge : state->next.at(c)) {
+          Transition transition;
+          transition.c = c;
+          transition.target = edge.target ? toIndex.at(edge.target) : nullIndex;
+          transition.resetBegin = resetVars.size();
+          resetVars.insert(resetVars.end(), edge.resetVars.begin(), edge.resetVars.end());
+          transition.resetEnd = resetVars.size();
+          transition.guardBegin = guards.size();
+          guards.insert(guards.end(), edge.guard.begin(), edge.guard.end());
+          transition.guardEnd = guards.size();
+          transitions.push_back(transition);
+        }
+      }
+      transitionBegin.push_back(transitions.size());
+    }
+  }
+
+  inline std::size_t stateSize() const { return states.size(); }
+
+  /*!
+    @brief Remove the transitions satisfying pred
+
+    @param [in] pred A predicate taking the index of the source state and the transition
+   */
+  template <class Predicate> void eraseTransitions(Predicate pred) {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < stateSize(); ++i) {
+      const std::size_t begin = transitionBegin[i];
+      transitionBegin[i] = size;
+      for (std::size_t k = begin; k < transitionBegin[i + 1]; ++k) {
+        if (!pred(i, transitions[k])) {
+          transitions[size++] = transitions[k];
+        }
+      }
+    }
+    transitionBegin.back() = size;
+    transitions.resize(size);
+  }
+
+  /*!
+    @brief Append the states and the transitions of another automaton to make the disjoint union
+
+    The i-th state of other becomes the (stateSize() + i)-th state. The clock variables are shared, and the maximum
+    constant of each clock is the larger one.
+   */
+  void append(const IndexedTimedAutomaton &other) {
+    const std::size_t stateOffset = stateSize();
+    const std::size_t transitionOffset = transitions.size();
+    const auto resetOffset = static_cast<std::uint32_t>(resetVars.size());
+    const auto guardOffset = static_cast<std::uint32_t>(guards.size());
+    states.insert(states.end(), other.states.begin(), other.states.end());
+    for (std::size_t i : other.initialStates) {
+      initialStates.push_back(stateOffset + i);
+    }
+    for (std::size_t i = 1; i < other.transitionBegin.size(); ++i) {
+      transitionBegin.push_back(transitionOffset + other.transitionBegin[i]);
+    }
+    for (Transition transition : other.transitions) {
+      if (transition.target != nullIndex) {
+        transition.target += stateOffset;
+      }
+      transition.resetBegin += resetOffset;
+      transition.resetEnd += resetOffset;
+      transition.guardBegin += guardOffset;
+      transition.guardEnd += guardOffset;
+      transitions.push_back(transition);
+    }
+    resetVars.insert(resetVars.end(), other.resetVars.begin(), other.resetVars.end());
+    guards.insert(guards.end(), other.guards.begin(), other.guards.end());
+    if (maxConstraints.size() < other.maxConstraints.size()) {
+      maxConstraints.resize(other.maxConstraints.size(), 0);
+    }
+    for (std::size_t x = 0; x < other.maxConstraints.size(); ++x) {
+      maxConstraints[x] = std::max(maxConstraints[x], other.maxConstraints[x]);
+    }
+  }
+
+  /*!
+    @brief Construct the timed automaton with pointers used in the matching
+
+    @param [out] TA The timed automaton. TA.states[i] corresponds to the i-th state.
+   */
+  void toTimedAutomaton(TimedAutomaton &TA) const {
+    TA.states.clear();
+    TA.states.reserve(stateSize());
+    for (const State &state : states) {
+      TA.states.push_back(std::make_shared<TAState>(state.isMatch));
+      TA.states.back()->zeroDuration = state.zeroDuration;
+    }
+    TA.initialStates.clear();
+    TA.initialStates.reserve(initialStates.size());
+    for (std::size_t i : initialStates) {
+      TA.initialStates.push_back(TA.states[i]);
+    }
+    for (std::size_t i = 0; i < stateSize(); ++i) {
+      for (std::size_t k = transitionBegin[i]; k < transitionBegin[i + 1]; ++k) {
+        const Transition &transition = transitions[k];
+        TA.states[i]->next[transition.c].push_back(
+            {transition.target == nullIndex ? nullptr : TA.states[transition.target].get(),
+             std::vector<ClockVariables>(resetVars.begin() + transition.resetBegin,
+                                         resetVars.begin() + transition.resetEnd),
+             std::vector<Constraint>(guards.begin() + transition.guardBegin, guards.begin() + transition.guardEnd)});
+      }
+    }
+    TA.maxConstraints = maxConstraints;
+  }
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <boost/variant.hpp>
 #include <iostream>
 
@@ -149,8 +150,14 @@ public:
     return newestClock = newClock;
   }
 
-  void
-  update(const std::vector<boost::variant<double, ClockVariables>> &resetTime) {
+  /*!
+    @brief remove the variables not referred to any more
+
+    When the remaining variables are only t and the newest one, the zone goes
+    back to the intervals, and the references to the newest variable in
+    resetTime are renamed accordingly.
+   */
+  void update(std::vector<boost::variant<double, ClockVariables>> &resetTime) {
     if (useInterval) {
       return;
     }
@@ -172,6 +179,35 @@ public:
         deallocate(x);
       }
     }
+    if (newestClock != initialClock &&
+        std::all_of(resetTime.begin(), resetTime.end(), [&](const auto &rtime) {
+          const ClockVariables *p_x = boost::get<ClockVariables>(&rtime);
+          return !p_x || *p_x == initialClock || *p_x == newestClock;
+        })) {
+      for (auto &rtime : resetTime) {
+        ClockVariables *p_x = boost::get<ClockVariables>(&rtime);
+        if (p_x && *p_x == newestClock) {
+          *p_x = 2;
+        }
+      }
+      toInterval();
+    }
+  }
+
+  /*!
+    @brief go back to the intervals of t, t', and t' - t
+
+    @pre The zone is canonical and the variables other than t and the newest one
+    are not referred to.
+   */
+  void toInterval() {
+    intervals = {Interval{value(0, initialClock), value(initialClock, 0)},
+                 Interval{value(0, newestClock), value(newestClock, 0)},
+                 Interval{value(initialClock, newestClock),
+                          value(newestClock, initialClock)}};
+    useInterval = true;
+    isAllocated.clear();
+    newestClock = 2;
   }
 
   void toAns(Zone &ansZone) const {
@@ -357,6 +393,40 @@ public:
     }
   }
 
+  /*!
+    @brief check if both zones are the same including their representation
+   */
+  bool operator==(const IntermediateZone &z) const {
+    if (useInterval != z.useInterval) {
+      return false;
+    }
+    if (useInterval) {
+      return std::equal(intervals.begin(), intervals.end(), z.intervals.begin(),
+                        z.intervals.end(),
+                        [](const Interval &left, const Interval &right) {
+                          return left.lowerBound == right.lowerBound &&
+                                 left.upperBound == right.upperBound;
+                        });
+    }
+    return newestClock == z.newestClock && value.cols() == z.value.cols() &&
+           value == z.value;
+  }
+
+  //! @brief A hash value consistent with operator==
+  std::size_t hash() const {
+    if (!useInterval) {
+      return Zone::hash();
+    }
+    std::size_t seed = intervals.size();
+    for (const Interval &interval : intervals) {
+      boost::hash_combine(seed, std::hash<double>{}(interval.lowerBound.first));
+      boost::hash_combine(seed, interval.lowerBound.second);
+      boost::hash_combine(seed, std::hash<double>{}(interval.upperBound.first));
+      boost::hash_combine(seed, interval.upperBound.second);
+    }
+    return seed;
+  }
+
   bool isSatisfiableCanonized() {
     if (useInterval) {
       return std::all_of(intervals.begin(), intervals.end(),
@@ -1,4 +1,43 @@
 #include "intersection.hh"
+
+#include <algorithm>
+#include <deque>
+
+namespace {
+  /*!
+    @brief Make the transition of the product automaton
+
+    The clock variables of the second automaton are shifted by clockSize1.
+   */
+  TATransition makeProductTransition(TAState *target, const TATransition &e1,
+                                     const TATransition &e2,
+                                     std::size_t clockSize1) {
+    TATransition transition;
+    transition.target = target;
+
+    // concat resetVars
+    transition.resetVars.reserve(e1.resetVars.size() + e2.resetVars.size());
+    transition.resetVars.insert(transition.resetVars.end(),
+                                e1.resetVars.begin(), e1.resetVars.end());
+    transition.resetVars.insert(transition.resetVars.end(),
+                                e2.resetVars.begin(), e2.resetVars.end());
+    std::for_each(transition.resetVars.begin() + e1.resetVars.size(),
+                  transition.resetVars.end(),
+                  [&](ClockVariables &v) { v += clockSize1; });
+
+    // concat constraints
+    transition.guard.reserve(e1.guard.size() + e2.guard.size());
+    transition.guard.insert(transition.guard.end(), e1.guard.begin(),
+                            e1.guard.end());
+    transition.guard.insert(transition.guard.end(), e2.guard.begin(),
+                            e2.guard.end());
+    std::for_each(transition.guard.begin() + e1.guard.size(),
+                  transition.guard.end(),
+                  [&](Constraint &guard) { guard.x += clockSize1; });
+
+    return transition;
+  }
+} // namespace
 /*
   Specifications
   ==============
@@ -54,30 +93,9 @@ void intersectionTA(const TimedAutomaton &in1, const TimedAutomaton &in2,
                                         TAState *nextS1, TAState *nextS2,
                                         const TATransition &e1,
                                         const TATransition &e2, char c) {
-    TATransition transition;
-    transition.target = toIState[std::make_pair(nextS1, nextS2)].get();
-
-    // concat resetVars
-    transition.resetVars.reserve(e1.resetVars.size() + e2.resetVars.size());
-    transition.resetVars.insert(transition.resetVars.end(),
-                                e1.resetVars.begin(), e1.resetVars.end());
-    transition.resetVars.insert(transition.resetVars.end(),
-                                e2.resetVars.begin(), e2.resetVars.end());
-    std::for_each(transition.resetVars.begin() + e1.resetVars.size(),
-                  transition.resetVars.end(),
-                  [&](ClockVariables &v) { v += in1.clockSize(); });
-
-    // concat constraints
-    transition.guard.reserve(e1.guard.size() + e2.guard.size());
-    transition.guard.insert(transition.guard.end(), e1.guard.begin(),
-                            e1.guard.end());
-    transition.guard.insert(transition.guard.end(), e2.guard.begin(),
-                            e2.guard.end());
-    std::for_each(transition.guard.begin() + e1.guard.size(),
-                  transition.guard.end(),
-                  [&](Constraint &guard) { guard.x += in1.clockSize(); });
-
-    toIState[std::make_pair(s1, s2)]->next[c].push_back(std::move(transition));
+    toIState[std::make_pair(s1, s2)]->next[c].push_back(makeProductTransition(
+        toIState[std::make_pair(nextS1, nextS2)].get(), e1, e2,
+        in1.clockSize()));
   };
 
   TATransition emptyTransition;
@@ -130,6 +148,106 @@ void intersectionTA(const TimedAutomaton &in1, const TimedAutomaton &in2,
   }
 }
 
+void reachableIntersectionTA(
+    const TimedAutomaton &in1, const TimedAutomaton &in2, TimedAutomaton &out,
+    boost::unordered_map<std::pair<TAState *, TAState *>,
+                         std::shared_ptr<TAState>> &toIState) {
+  // toIState :: (in1.State, in2.State) -> out.State
+  std::deque<std::pair<TAState *, TAState *>> waiting;
+  // Returns the product state, which is constructed if it is new.
+  const auto getState = [&](TAState *s1, TAState *s2) -> TAState * {
+    if (s1->zeroDuration != s2->zeroDuration) {
+      return nullptr;
+    }
+    const auto key = std::make_pair(s1, s2);
+    auto it = toIState.find(key);
+    if (it != toIState.end()) {
+      return it->second.get();
+    }
+    auto state = std::make_shared<TAState>(s1->isMatch && s2->isMatch);
+    state->zeroDuration = s1->zeroDuration;
+    toIState[key] = state;
+    out.states.push_back(state);
+    waiting.push_back(key);
+    return state.get();
+  };
+
+  // make initial states
+  out.initialStates.clear();
+  out.initialStates.reserve(in1.initialStates.size() *
+                            in2.initialStates.size());
+  for (const auto &s1 : in1.initialStates) {
+    for (const auto &s2 : in2.initialStates) {
+      if (getState(s1.get(), s2.get())) {
+        out.initialStates.push_back(
+            toIState.at(std::make_pair(s1.get(), s2.get())));
+      }
+    }
+  }
+
+  // make max constraints
+  out.maxConstraints.reserve(in1.maxConstraints.size() +
+                             in2.maxConstraints.size()); // preallocate memory
+  out.maxConstraints.insert(out.maxConstraints.end(),
+                            in1.maxConstraints.begin(),
+                            in1.maxConstraints.end());
+  out.maxConstraints.insert(out.maxConstraints.end(),
+                            in2.maxConstraints.begin(),
+                            in2.maxConstraints.end());
+
+  TATransition emptyTransition;
+  // make edges of the reachable states
+  while (!waiting.empty()) {
+    TAState *s1 = waiting.front().first;
+    TAState *s2 = waiting.front().second;
+    const std::shared_ptr<TAState> state = toIState.at(waiting.front());
+    waiting.pop_front();
+
+    // Epsilon transitions
+    auto eps1 = s1->next.find(0);
+    if (eps1 != s1->next.end()) {
+      for (const auto &e1 : eps1->second) {
+        if (!e1.target) {
+          continue;
+        }
+        state->next[0].push_back(makeProductTransition(
+            getState(e1.target, s2), e1, emptyTransition, in1.clockSize()));
+      }
+    }
+    auto eps2 = s2->next.find(0);
+    if (eps2 != s2->next.end()) {
+      for (const auto &e2 : eps2->second) {
+        if (!e2.target) {
+          continue;
+        }
+        state->next[0].push_back(makeProductTransition(
+            getState(s1, e2.target), emptyTransition, e2, in1.clockSize()));
+      }
+    }
+
+    // Observable transitions
+    for (const auto &pair1 : s1->next) {
+      const Alphabet c = pair1.first;
+      auto it2 = s2->next.find(c);
+      if (it2 == s2->next.end()) {
+        continue;
+      }
+      for (const auto &e1 : pair1.second) {
+        if (!e1.target) {
+          continue;
+        }
+        for (const auto &e2 : it2->second) {
+          if (!e2.target) {
+            continue;
+          }
+          state->next[c].push_back(makeProductTransition(
+              getState(e1.target, e2.target), e1, e2, in1.clockSize()));
+        }
+      }
+    }
+  }
+}
+
 void updateInitAccepting(const TimedAutomaton &in1, const TimedAutomaton &in2,
                          TimedAutomaton &out,
                          boost::unordered_map<std::pair<TAState *, TAState *>,
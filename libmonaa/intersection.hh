@@ -15,6 +15,20 @@ void intersectionTA(const TimedAutomaton &in1, const TimedAutomaton &in2,
                     boost::unordered_map<std::pair<TAState *, TAState *>,
                                          std::shared_ptr<TAState>> &toIState);
 
+/*!
+  @brief Construct the product of two timed automata only with the states
+  reachable from the initial states.
+
+  The specification is the same as intersectionTA except that toIState and
+  out contain only the reachable product states. Since the product states are
+  constructed on the fly from the initial pairs, the time and memory are
+  proportional to the reachable part of the product.
+*/
+void reachableIntersectionTA(
+    const TimedAutomaton &in1, const TimedAutomaton &in2, TimedAutomaton &out,
+    boost::unordered_map<std::pair<TAState *, TAState *>,
+                         std::shared_ptr<TAState>> &toIState);
+
 void updateInitAccepting(const TimedAutomaton &in1, const TimedAutomaton &in2,
                          TimedAutomaton &out,
                          boost::unordered_map<std::pair<TAState *, TAState *>,
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "compiled_pattern.hh"
+#include "online_monitor.hh"
+#include "spsc_ring_buffer.hh"
+
+/*!
+  @file keyed_monaa.hh
+  @brief Timed pattern matching of a log interleaving the timed words of many keys, e.g., vehicles or sessions
+ */
+
+/*!
+  @brief Read one event with its key. The format is "key character timestamp" in each line.
+
+  The key is any string without a space, and it is not truncated however long it is.
+
+  @returns 3 if an event is read. Otherwise, the line is not in the format or it is the end of the file.
+ */
+static inline int getOneKeyed(FILE *file, std::string &key, std::pair<Alphabet, double> &p) {
+  key.clear();
+  int c;
+  while ((c = getc(file)) != EOF && std::isspace(c)) {
+  }
+  while (c != EOF && !std::isspace(c)) {
+    key.push_back(static_cast<char>(c));
+    c = getc(file);
+  }
+  if (key.empty()) {
+    return EOF;
+  }
+  return 1 + fscanf(file, " %c %lf\n", &p.first, &p.second);
+}
+
+/*!
+  @brief A monitor matching a pattern to the timed word of each key independently
+
+  Each key has its own @link OnlineMonitor @endlink, i.e., its own configurations and skip position, and all the
+  monitors share the compiled pattern including the skip values. The events are fed as they arrive, and each answer
+  zone is given to the callback as soon as the event deciding it is fed.
+
+  With many threads, the keys are sharded to the threads by the hash of their names. Each thread owns the monitors of
+  its keys and receives their events through a @link SPSCRingBuffer @endlink, and the calls of the callback are
+  serialized. The answer zones of each key are given in the same order as @link monaaDollar @endlink, but the order
+  among the keys depends on the threads.
+
+  @note The pattern must be compiled for the event mode.
+ */
+class KeyedMonitor {
+public:
+  //! @brief The function called with the key and the answer zone of each matching. The zone is overwritten after it.
+  using Callback = std::function<void(const std::string &, const Zone &)>;
+
+  /*!
+    @param [in] pattern A pattern compiled for the event mode.
+    @param [in] callback The function called with the key and the answer zone of each matching.
+    @param [in] threadSize The number of the threads matching the keys. If it is 1, the keys are matched in the thread
+    calling feed(). If it is 0, we use the number of the hardware threads.
+    @param [in] capacity The capacity of the buffer of the events for each thread.
+    @throws std::invalid_argument if the pattern is not for the event mode
+   */
+  KeyedMonitor(std::shared_ptr<const CompiledPattern> pattern, Callback callback, std::size_t threadSize = 1,
+               std::size_t capacity = 4096)
+      : pattern(std::move(pattern)), callback(std::move(callback)) {
+    OnlineMonitor::requireSupported(*this->pattern);
+    if (threadSize == 0) {
+      threadSize = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+    shards.reserve(threadSize);
+    for (std::size_t k = 0; k < threadSize; ++k) {
+      shards.push_back(std::make_unique<Shard>(capacity));
+    }
+    if (threadSize > 1) {
+      for (auto &shard : shards) {
+        shard->thread = std::thread(&KeyedMonitor::consume, this, std::ref(*shard));
+      }
+    }
+  }
+
+  KeyedMonitor(const KeyedMonitor &) = delete;
+  KeyedMonitor &operator=(const KeyedMonitor &) = delete;
+
+  //! @brief Stop the threads without finishing the matching
+  ~KeyedMonitor() { stop(); }
+
+  /*!
+    @brief Push an event of a key and match as far as possible
+
+    @throws The exception thrown by the callback in a thread, if any
+   */
+  void feed(const std::string &key, Alphabet c, double timestamp) {
+    auto it = toIndex.find(key);
+    if (it == toIndex.end()) {
+      Shard &shard = *shards[hash(key) % shards.size()];
+      it = toIndex.emplace(key, Index{&shard, shard.keySize++}).first;
+    }
+    const Message message{&it->first, it->second.local, c, timestamp};
+    if (shards.size() == 1) {
+      process(*shards.front(), message);
+    } else if (!it->second.shard->events.push(message)) {
+      // the thread stopped by an exception
+      finish();
+    }
+  }
+
+  /*!
+    @brief Notify the end of the timed words of all the keys
+
+    The matchings ending after the last event of each key are given to the callback, and the threads are joined.
+
+    @throws The exception thrown by the callback in a thread, if any
+   */
+  void finish() {
+    if (shards.size() == 1 && !isFinished) {
+      for (OnlineMonitor &monitor : shards.front()->monitors) {
+        monitor.finish();
+      }
+    }
+    isFinished = true;
+    for (auto &shard : shards) {
+      shard->events.close();
+    }
+    stop();
+    for (auto &shard : shards) {
+      if (shard->error) {
+        std::rethrow_exception(std::exchange(shard->error, nullptr));
+      }
+    }
+  }
+
+  //! @brief Returns the number of the keys fed so far
+  std::size_t keySize() const { return toIndex.size(); }
+
+private:
+  //! @brief An event of a key sent to the thread owning the key
+  struct Message {
+    //! @brief The name of the key. It is used when the key first appears.
+    const std::string *key;
+    //! @brief The index of the key among the keys of the thread
+    std::size_t local;
+    Alphabet c;
+    double timestamp;
+  };
+
+  //! @brief The keys owned by a thread
+  struct Shard {
+    explicit Shard(std::size_t capacity) : events(capacity) {}
+    SPSCRingBuffer<Message> events;
+    //! @brief The monitor of each key of this shard. We use std::deque so that the monitors are never moved.
+    std::deque<OnlineMonitor> monitors;
+    //! @brief The number of the keys of this shard assigned by feed(). It is used only by the feeding thread.
+    std::size_t keySize = 0;
+    std::exception_ptr error;
+    std::thread thread;
+  };
+
+  struct Index {
+    Shard *shard;
+    std::size_t local;
+  };
+
+  std::shared_ptr<const CompiledPattern> pattern;
+  Callback callback;
+  std::mutex callbackMutex;
+  std::vector<std::unique_ptr<Shard>> shards;
+  //! @brief The shard of each key. The threads refer to the names of the keys, which are not moved by the insertions.
+  std::unordered_map<std::string, Index> toIndex;
+  std::hash<std::string> hash;
+  //! @brief If finish() is called. It is read by the threads after their buffers are closed.
+  std::atomic<bool> isFinished{false};
+
+  //! @brief Feed an event to the monitor of its key, making the monitor if the key first appears
+  void process(Shard &shard, const Message &message) {
+    if (message.local == shard.monitors.size()) {
+      const std::string *key = message.key;
+      shard.monitors.emplace_back(pattern, [this, key](const Zone &zone) {
+        if (shards.size() == 1) {
+          callback(*key, zone);
+        } else {
+          std::lock_guard<std::mutex> lock(callbackMutex);
+          callback(*key, zone);
+        }
+      });
+    }
+    shard.monitors[message.local].feed(message.c, message.timestamp);
+  }
+
+  //! @brief The loop of a thread consuming the events of its keys
+  void consume(Shard &shard) {
+    try {
+      Message message;
+      while (shard.events.pop(message)) {
+        process(shard, message);
+      }
+      if (isFinished) {
+        for (OnlineMonitor &monitor : shard.monitors) {
+          monitor.finish();
+        }
+      }
+    } catch (...) {
+      shard.error = std::current_exception();
+      shard.events.close();
+    }
+  }
+
+  //! @brief Close the buffers and join the threads
+  void stop() {
+    for (auto &shard : shards) {
+      shard->events.close();
+      if (shard->thread.joinable()) {
+        shard->thread.join();
+      }
+    }
+  }
+};
+
+/*!
+  @brief Read a log with a key column and feed its events to a keyed monitor as they are read
+
+  @note The reading stops at the first line not in the format.
+  @returns The number of the events read
+ */
+inline std::size_t keyedMonaa(FILE *file, KeyedMonitor &monitor) {
+  std::size_t size = 0;
+  std::string key;
+  std::pair<Alphabet, double> elem;
+  while (getOneKeyed(file, key, elem) == 3) {
+    monitor.feed(key, elem.first, elem.second);
+    size++;
+  }
+  monitor.finish();
+  return size;
+}
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <numeric>
 #include <unordered_map>
+#include <vector>
 
+#include "indexed_timed_automaton.hh"
 #include "intersection.hh"
 #include "ta2za.hh"
 #include "timed_automaton.hh"
@@ -12,14 +16,19 @@
  * @brief The skip value function based on the KMP algorithm for string matching
  *
  * @note We construct the table maintaining all the skip values in the constructor for the efficiency at runtime.
+ * @note The zone automaton of the product is constructed only once for all n, and the reachability to the accepting
+ * states is checked for each n on it.
  * @sa https://doi.org/10.1137%2F0206024
  */
 class KMPSkipValue {
 private:
   std::unordered_map<const TAState *, int> beta;
+  std::chrono::nanoseconds constructionTime{0};
+  std::chrono::nanoseconds ta2zaTime{0};
 
 public:
   KMPSkipValue(const TimedAutomaton &TA, int m) {
+    const auto begin = std::chrono::steady_clock::now();
     ZoneAutomaton ZA2;
     TimedAutomaton A2;
     boost::unordered_map<std::pair<TAState *, TAState *>,
@@ -28,9 +37,10 @@ public:
     // A0 is the automaton in A_{+n}^* in the paper. What we do is: 1) construct
     // a dummy accepting state, and 2) construct m-dummy states to the original
     // initial states
+    // The i-th states of the copies A0 and As correspond to TA.states[i].
+    const IndexedTimedAutomaton indexed(TA);
     TimedAutomaton A0;
-    std::unordered_map<TAState *, std::shared_ptr<TAState>> old2new0;
-    TA.deepCopy(A0, old2new0);
+    indexed.toTimedAutomaton(A0);
     // Vector of extended initial states. if the accepting state is
     // extendedInitialStates[n], the TA reads n-additional events.
     std::vector<std::shared_ptr<TAState>> extendedInitialStates(m + 1);
@@ -83,9 +93,7 @@ public:
     // As is the automaton in A_{s}^* in the paper. What we do is to construct a
     // dummy state for each state s.
     TimedAutomaton As;
-    std::unordered_map<TAState *, std::shared_ptr<TAState>> old2newS;
-    old2newS.reserve(TA.states.size());
-    TA.deepCopy(As, old2newS);
+    indexed.toTimedAutomaton(As);
     std::unordered_map<std::shared_ptr<TAState>, std::shared_ptr<TAState>>
         toDummyState;
     toDummyState.reserve(TA.states.size());
@@ -103,32 +111,109 @@ public:
       As.states.push_back(dummyState.second);
     }
 
-    intersectionTA(A0, As, A2, toIState);
+    // We only need the product states reachable from the extended initial states
+    A0.initialStates.assign(extendedInitialStates.begin() + 1, extendedInitialStates.end());
+    reachableIntersectionTA(A0, As, A2, toIState);
 
-    // Calculate KMP-type skip value
-    for (const auto& origState : TA.states) {
-      for (auto &stateAs : As.states) {
-        stateAs->isMatch = stateAs == old2newS[origState.get()] ||
-                           stateAs == toDummyState[old2newS[origState.get()]];
+    // The original state of each state in As
+    std::unordered_map<const TAState *, std::size_t> toOrigIndex;
+    toOrigIndex.reserve(TA.states.size() * 2);
+    for (std::size_t k = 0; k < TA.states.size(); ++k) {
+      const auto &copiedState = As.states[k];
+      toOrigIndex[copiedState.get()] = k;
+      toOrigIndex[toDummyState.at(copiedState).get()] = k;
+    }
+    // The original state s such that we reach an accepting state of A0 and s (or its dummy state) in As.
+    std::unordered_map<const TAState *, std::size_t> acceptingOrigIndex;
+    for (const auto &pair : toIState) {
+      if (pair.first.first && pair.first.first->isMatch && pair.second) {
+        auto it = toOrigIndex.find(pair.first.second);
+        if (it != toOrigIndex.end()) {
+          acceptingOrigIndex[pair.second.get()] = it->second;
+        }
+      }
+    }
+    // The initial states of A2 for each n
+    std::vector<std::vector<const TAState *>> initialStatesN(m + 1);
+    A2.initialStates.clear();
+    for (int n = 1; n <= m; n++) {
+      for (const auto &init2 : As.initialStates) {
+        if (extendedInitialStates[n]->zeroDuration != init2->zeroDuration) {
+          continue;
+        }
+        auto it = toIState.find(std::make_pair(extendedInitialStates[n].get(), init2.get()));
+        if (it != toIState.end() && it->second) {
+          initialStatesN[n].push_back(it->second.get());
+          A2.initialStates.push_back(it->second);
+        }
       }
-      // Find the minimum n such that the intersection of the two languages is
-      // not empty.
+    }
+
+    // We construct the zone automaton only once for all n
+    const auto ta2zaBegin = std::chrono::steady_clock::now();
+    ta2za(A2, ZA2);
+    ta2zaTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - ta2zaBegin);
+
+    // reachable[n][k] is true if we reach the accepting state for TA.states[k] after n additional events
+    std::vector<std::vector<bool>> reachable(m + 1, std::vector<bool>(TA.states.size(), false));
+    const auto computeReachable = [&](int n) {
+      std::vector<bool> visited(ZA2.states.size(), false);
+      std::vector<std::size_t> waiting;
+      for (std::size_t k = 0; k < ZA2.states.size(); ++k) {
+        if (std::find(initialStatesN[n].begin(), initialStatesN[n].end(), ZA2.states[k]->taState) !=
+            initialStatesN[n].end()) {
+          visited[k] = true;
+          waiting.push_back(k);
+        }
+      }
+      while (!waiting.empty()) {
+        const ZAState *zaState = ZA2.states[waiting.back()].get();
+        waiting.pop_back();
+        auto it = acceptingOrigIndex.find(zaState->taState);
+        if (it != acceptingOrigIndex.end()) {
+          reachable[n][it->second] = true;
+        }
+        for (const auto &edge : zaState->next) {
+          if (!visited[edge.target]) {
+            visited[edge.target] = true;
+            waiting.push_back(edge.target);
+          }
+        }
+      }
+    };
+
+    for (int n = 1; n <= m; n++) {
+      computeReachable(n);
+    }
+
+    // Calculate KMP-type skip value, i.e., the minimum n such that the intersection of the two languages is not empty.
+    for (std::size_t k = 0; k < TA.states.size(); ++k) {
+      // When the emptiness checking always failed, we set m
+      beta[TA.states[k].get()] = m;
       for (int n = 1; n <= m; n++) {
-        A0.initialStates = {extendedInitialStates[n]};
-        updateInitAccepting(A0, As, A2, toIState);
-        std::sort(A2.initialStates.begin(), A2.initialStates.end());
-        ta2za(A2, ZA2);
-        ZA2.updateInitAccepting(A2.initialStates);
-        if (!ZA2.empty()) {
-          beta[origState.get()] = n;
+        if (reachable[n][k]) {
+          beta[TA.states[k].get()] = n;
           break;
         }
       }
-      // When the emptiness checking always failed, we set m
-      beta.insert(std::make_pair(origState.get(), m));
     }
+
+    constructionTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
   }
 
+  /*!
+   * @brief Restore the skip values computed in advance, e.g., loaded from a compiled pattern
+   */
+  explicit KMPSkipValue(std::unordered_map<const TAState *, int> beta,
+                        std::chrono::nanoseconds constructionTime = std::chrono::nanoseconds{0},
+                        std::chrono::nanoseconds ta2zaTime = std::chrono::nanoseconds{0})
+      : beta(std::move(beta)), constructionTime(constructionTime), ta2zaTime(ta2zaTime) {}
+
+  //! @brief The time to construct the skip value table
+  std::chrono::nanoseconds getConstructionTime() const { return constructionTime; }
+  //! @brief The time to construct the zone automaton, which is included in getConstructionTime()
+  std::chrono::nanoseconds getTa2zaTime() const { return ta2zaTime; }
+
   inline int at(const TAState *s) const { return beta.at(s); }
   inline int operator[](const TAState *s) const { return beta.at(s); }
   inline int at(const std::shared_ptr<TAState>& s) const { return beta.at(s.get()); }
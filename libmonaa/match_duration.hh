@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include "indexed_timed_automaton.hh"
+#include "ta2za.hh"
+#include "timed_automaton.hh"
+#include "word_container.hh"
+#include "zone_automaton.hh"
+
+/*!
+ * @brief The minimum and the maximum duration of the matchings of a pattern
+ *
+ * We add a clock never reset to the timed automaton, and take its bounds at the accepting states of the zone
+ * automaton. Since the zones are abstracted, the bounds are not necessarily tight, but the duration t' - t of any
+ * matching is in [getMin(), getMax()].
+ */
+class MatchDuration {
+private:
+  double minDuration = 0;
+  double maxDuration = std::numeric_limits<double>::infinity();
+
+public:
+  explicit MatchDuration(const TimedAutomaton &TA) {
+    if (TA.maxConstraints.empty()) {
+      return;
+    }
+    const int M = *std::max_element(TA.maxConstraints.begin(), TA.maxConstraints.end());
+    if (M <= 0) {
+      return;
+    }
+    TimedAutomaton durationTA;
+    IndexedTimedAutomaton(TA).toTimedAutomaton(durationTA);
+    // The clock measuring the duration from the beginning of the matching. Since the zones drop the constraints
+    // compared with a constant greater than or equal to the maximum constant, we use M + 1 to keep the guards
+    // compared with M.
+    const ClockVariables durationClock = TA.clockSize();
+    durationTA.maxConstraints.push_back(M + 1);
+
+    ZoneAutomaton ZA;
+    ta2za(durationTA, ZA);
+    bool accepted = false;
+    double lower = std::numeric_limits<double>::infinity();
+    double upper = 0;
+    for (const auto &state : ZA.states) {
+      if (!state->isMatch) {
+        continue;
+      }
+      accepted = true;
+      lower = std::min(lower, -state->zone.value(0, durationClock + 1).first);
+      upper = std::max(upper, state->zone.value(durationClock + 1, 0).first);
+    }
+    if (accepted) {
+      minDuration = std::max(lower, 0.0);
+      maxDuration = upper;
+    }
+  }
+
+  //! @brief Restore the bounds computed in advance, e.g., loaded from a compiled pattern
+  MatchDuration(double minDuration, double maxDuration) : minDuration(minDuration), maxDuration(maxDuration) {}
+
+  //! @brief The lower bound of the duration of the matchings
+  double getMin() const { return minDuration; }
+  //! @brief The upper bound of the duration of the matchings. This is infinity if it is unbounded.
+  double getMax() const { return maxDuration; }
+
+  /*!
+   * @brief Returns the first starting position not excluded by the maximum duration
+   *
+   * A matching starting from the i-th position and containing the last-th event is longer than
+   * word[last].second - word[i].second. We find the first position k in [i, last] such that this is not longer than
+   * the maximum duration by binary search.
+   *
+   * @pre The events from i to last are fetched.
+   */
+  template <class InputContainer>
+  std::size_t nextStart(WordContainer<InputContainer> &word, std::size_t i, std::size_t last) const {
+    const double threshold = word[last].second - maxDuration;
+    if (word[i].second >= threshold) {
+      return i;
+    }
+    std::size_t low = i + 1, high = last;
+    while (low < high) {
+      const std::size_t mid = low + (high - low) / 2;
+      if (word[mid].second < threshold) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+};
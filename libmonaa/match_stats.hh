@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include "clock_reduction.hh"
+#include "state_minimization.hh"
+
+/*!
+  @file match_stats.hh
+  @brief Statistics of a run of the timed pattern matching
+ */
+
+/*!
+  @brief The counters of the matching loop
+
+  They are counted by @link monaa @endlink and @link monaaDollar @endlink if a pointer to this is given. The
+  parallel matchings count each chunk separately and merge() the counters after the matching.
+ */
+struct MatchCounters {
+  //! @brief The number of the events in the timed word
+  std::size_t events = 0;
+  //! @brief The number of the shifts by Sunday's skip value
+  std::size_t sundayShifts = 0;
+  //! @brief The sum of the lengths of the shifts by Sunday's skip value
+  std::size_t sundayShiftLength = 0;
+  //! @brief The number of the shifts by the KMP-type skip value
+  std::size_t kmpShifts = 0;
+  //! @brief The sum of the lengths of the shifts by the KMP-type skip value
+  std::size_t kmpShiftLength = 0;
+  //! @brief The number of the configurations made by the transitions
+  std::size_t configurations = 0;
+  //! @brief The maximum number of the current configurations
+  std::size_t peakConfigurations = 0;
+  //! @brief The maximum number of the events read from one starting position
+  std::size_t peakWindow = 0;
+
+  void sundayShift(std::size_t n) {
+    sundayShifts++;
+    sundayShiftLength += n;
+  }
+  void kmpShift(std::size_t n) {
+    kmpShifts++;
+    kmpShiftLength += n;
+  }
+  //! @brief Count the configurations made by the transitions from the previous ones
+  void expand(std::size_t size) {
+    configurations += size;
+    peakConfigurations = std::max(peakConfigurations, size);
+  }
+  //! @brief Update the peak window by the number of the events read from the current starting position
+  void window(std::size_t size) { peakWindow = std::max(peakWindow, size); }
+  /*!
+    @brief Add the counters of another matching, e.g., of another chunk matched in parallel
+
+    The numbers are summed, and the peaks are the larger ones.
+   */
+  void merge(const MatchCounters &other) {
+    events += other.events;
+    sundayShifts += other.sundayShifts;
+    sundayShiftLength += other.sundayShiftLength;
+    kmpShifts += other.kmpShifts;
+    kmpShiftLength += other.kmpShiftLength;
+    configurations += other.configurations;
+    peakConfigurations = std::max(peakConfigurations, other.peakConfigurations);
+    peakWindow = std::max(peakWindow, other.peakWindow);
+  }
+};
+
+/*!
+  @brief The statistics of a run of monaa, printed by the option --stats
+ */
+struct MatchStats {
+  //! @brief The time to parse the patterns
+  std::chrono::nanoseconds parse{0};
+  //! @brief The time to construct the timed automata from the parsed patterns and minimize them
+  std::chrono::nanoseconds build{0};
+  //! @brief The time to construct the zone automata for the skip values, which is included in sunday and kmp
+  std::chrono::nanoseconds ta2za{0};
+  //! @brief The time to construct Sunday's skip values
+  std::chrono::nanoseconds sunday{0};
+  //! @brief The time to construct the KMP-type skip values
+  std::chrono::nanoseconds kmp{0};
+  //! @brief The numbers of the states before and after the state minimization, summed over the patterns
+  StateMinimization states{0, 0};
+  //! @brief The numbers of the clock variables before and after the clock reduction, summed over the patterns
+  ClockReduction clocks{0, 0};
+  //! @brief The time to read the whole log before the matching. In the online matching, the reading is in match.
+  std::chrono::nanoseconds read{0};
+  //! @brief The time of the matching
+  std::chrono::nanoseconds match{0};
+  //! @brief The number of the events read
+  std::size_t events = 0;
+  //! @brief The number of the bytes parsed. It is unknown if the input is not seekable, e.g., a pipe.
+  std::optional<std::size_t> bytes;
+  //! @brief The number of the answer zones
+  std::size_t zones = 0;
+  //! @brief The counters of the matching loop. They are not collected for the keyed logs.
+  std::optional<MatchCounters> counters;
+
+  //! @brief Print the statistics in lines, each starting with header
+  void print(std::ostream &os, const std::string &header) const {
+    const auto printTime = [&](const char *name, std::chrono::nanoseconds time) {
+      os << header << name << ": " << toMillis(time) << " ms\n";
+    };
+    printTime("pattern parse", parse);
+    printTime("automaton build", build);
+    printTime("ta2za", ta2za);
+    printTime("Sunday skip value", sunday);
+    printTime("KMP skip value", kmp);
+    printTime("read", read);
+    printTime("match", match);
+    os << header << "states: " << states.before << " -> " << states.after << "\n";
+    os << header << "clock variables: " << clocks.before << " -> " << clocks.after << "\n";
+    os << header << "events: " << events << "\n";
+    os << header << "bytes: ";
+    if (bytes) {
+      os << *bytes << "\n";
+    } else {
+      os << "unknown\n";
+    }
+    if (counters) {
+      os << header << "Sunday shifts: " << counters->sundayShifts << " (average "
+         << average(counters->sundayShiftLength, counters->sundayShifts) << ")\n";
+      os << header << "KMP shifts: " << counters->kmpShifts << " (average "
+         << average(counters->kmpShiftLength, counters->kmpShifts) << ")\n";
+      os << header << "configurations: " << counters->configurations << " (peak " << counters->peakConfigurations
+         << ")\n";
+      os << header << "peak window: " << counters->peakWindow << " events\n";
+    }
+    os << header << "zones: " << zones << std::endl;
+  }
+
+  //! @brief Print the statistics as a JSON object. The times are in milliseconds.
+  void printJSON(std::ostream &os) const {
+    os << "{\"parse_ms\": " << toMillis(parse) << ", \"build_ms\": " << toMillis(build)
+       << ", \"ta2za_ms\": " << toMillis(ta2za) << ", \"sunday_ms\": " << toMillis(sunday)
+       << ", \"kmp_ms\": " << toMillis(kmp) << ", \"read_ms\": " << toMillis(read)
+       << ", \"match_ms\": " << toMillis(match) << ", \"states_before\": " << states.before
+       << ", \"states_after\": " << states.after << ", \"clocks_before\": " << clocks.before
+       << ", \"clocks_after\": " << clocks.after << ", \"events\": " << events << ", \"bytes\": ";
+    if (bytes) {
+      os << *bytes;
+    } else {
+      os << "null";
+    }
+    if (counters) {
+      os << ", \"sunday_shifts\": " << counters->sundayShifts
+         << ", \"sunday_shift_average\": " << average(counters->sundayShiftLength, counters->sundayShifts)
+         << ", \"kmp_shifts\": " << counters->kmpShifts
+         << ", \"kmp_shift_average\": " << average(counters->kmpShiftLength, counters->kmpShifts)
+         << ", \"configurations\": " << counters->configurations
+         << ", \"peak_configurations\": " << counters->peakConfigurations
+         << ", \"peak_window\": " << counters->peakWindow;
+    }
+    os << ", \"zones\": " << zones << "}" << std::endl;
+  }
+
+private:
+  static double toMillis(std::chrono::nanoseconds time) { return time.count() / 1000000.0; }
+  static double average(std::size_t sum, std::size_t count) { return count == 0 ? 0 : double(sum) / count; }
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "compiled_pattern.hh"
+#include "indexed_timed_automaton.hh"
+#include "timed_automaton.hh"
+
+/*!
+ * @brief Many patterns compiled into one timed automaton
+ *
+ * The automaton is the disjoint union of the automata of the patterns, and the accepting states are tagged with the
+ * index of their pattern. Since the skip values of the union are computed from all the runs of all the patterns, the
+ * Sunday's and the KMP-type skip values are the minimum safe shifts among the patterns, similarly to Commentz-Walter
+ * and Aho-Corasick algorithms for multiple strings. The bounds of the duration of the matchings are also the bounds
+ * among the patterns. The clock variables are shared by the patterns because each run is in one of them.
+ *
+ * @note We do not minimize the states of the union because it may merge the accepting states of different patterns.
+ */
+struct MergedPattern {
+  //! @brief The number of the patterns
+  std::size_t patternSize;
+  //! @brief The union of the patterns compiled as one pattern
+  CompiledPattern pattern;
+  //! @brief The index of the pattern of each accepting state of pattern.automaton
+  std::unordered_map<const TAState *, std::size_t> tags;
+
+  /*!
+   * @brief Merge and compile timed automata
+   *
+   * @param [in] automata The timed automata used as patterns. They are not modified.
+   * @param [in] mode How the log is interpreted
+   */
+  MergedPattern(const std::vector<const TimedAutomaton *> &automata, CompiledPattern::Mode mode)
+      : MergedPattern(Union(automata), mode) {}
+
+private:
+  //! @brief The disjoint union of timed automata and the index of the automaton of each state
+  struct Union {
+    std::size_t size;
+    TimedAutomaton automaton;
+    std::vector<std::size_t> tags;
+    explicit Union(const std::vector<const TimedAutomaton *> &automata) : size(automata.size()) {
+      IndexedTimedAutomaton indexed;
+      for (std::size_t k = 0; k < automata.size(); ++k) {
+        indexed.append(IndexedTimedAutomaton(*automata[k]));
+        tags.resize(indexed.stateSize(), k);
+      }
+      indexed.toTimedAutomaton(automaton);
+    }
+  };
+
+  // The i-th state of pattern.automaton corresponds to the i-th state of the union.
+  MergedPattern(const Union &merged, CompiledPattern::Mode mode)
+      : patternSize(merged.size), pattern(merged.automaton, mode) {
+    for (std::size_t i = 0; i < pattern.automaton.stateSize(); ++i) {
+      if (pattern.automaton.states[i]->isMatch) {
+        tags[pattern.automaton.states[i].get()] = merged.tags[i];
+      }
+    }
+  }
+};
@@ -28,12 +28,17 @@
 #include <climits>
 #include <cmath>
 #include <iostream>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "ans_vec.hh"
+#include "compiled_pattern.hh"
 #include "intermediate_zone.hh"
 #include "intersection.hh"
 #include "kmp_skip_value.hh"
+#include "match_duration.hh"
+#include "match_stats.hh"
+#include "merged_pattern.hh"
 #include "sunday_skip_value.hh"
 #include "ta2za.hh"
 #include "word_container.hh"
@@ -141,25 +146,214 @@ inline void updateConstraint(std::pair<double, bool> &upperConstraint,
   }
 }
 
+/*!
+  @brief Compute the answer zone of a matching accepted by a transition
+
+  @param [in] config The configuration before the transition.
+  @param [in] edge The transition to an accepting state.
+  @param [in] upperEndConstraint The upper bound of the end t' of the matching.
+  @param [in] lowerEndConstraint The negated lower bound of the end t' of the
+  matching.
+  @param [out] ansZone The answer zone over t and t'. It must be a 3x3 zone.
+  @returns true if and only if the answer zone is not empty
+ */
+inline bool solveAcceptingTransition(const IntervalInternalState &config,
+                                     const TATransition &edge,
+                                     Bounds upperEndConstraint,
+                                     Bounds lowerEndConstraint, Zone &ansZone) {
+  const Bounds zeroBounds = {0, true};
+  Bounds upperBeginConstraint = config.upperConstraint;
+  Bounds lowerBeginConstraint = config.lowerConstraint;
+
+  // value(2, 1) <= value(2, 0) + value(0, 1)
+  Bounds upperDeltaConstraint =
+      upperEndConstraint + lowerBeginConstraint;
+  // value(1, 2) <= value(1, 0) + value(0, 2)
+  Bounds lowerDeltaConstraint =
+      std::min(lowerEndConstraint + upperBeginConstraint, zeroBounds);
+
+  // solve delta
+  for (const auto &delta : edge.guard) {
+    if (config.resetTime[delta.x]) {
+      switch (delta.odr) {
+      case Constraint::Order::lt:
+      case Constraint::Order::le:
+        upperEndConstraint =
+            std::min(upperEndConstraint,
+                     Bounds{delta.c + config.resetTime[delta.x],
+                            {delta.odr == Constraint::Order::le}});
+        // (2, 1) <= (2, 0) + (0, 1)
+        upperDeltaConstraint =
+            std::min(upperDeltaConstraint,
+                     upperEndConstraint + lowerBeginConstraint);
+        // (1, 0) <= (1, 2) + (2, 0)
+        upperBeginConstraint =
+            std::min(upperBeginConstraint,
+                     lowerDeltaConstraint + upperEndConstraint);
+        break;
+      case Constraint::Order::gt:
+      case Constraint::Order::ge:
+        lowerEndConstraint =
+            std::min(lowerEndConstraint,
+                     Bounds{-delta.c - config.resetTime[delta.x],
+                            {delta.odr == Constraint::Order::ge}});
+        // (1, 2) <= (1, 0) + (0, 2)
+        lowerDeltaConstraint =
+            std::min(lowerDeltaConstraint,
+                     upperBeginConstraint + lowerEndConstraint);
+        // (0, 1) <= (0, 2) + (2, 1)
+        lowerBeginConstraint =
+            std::min(lowerBeginConstraint,
+                     lowerEndConstraint + upperDeltaConstraint);
+        break;
+      }
+    } else {
+      switch (delta.odr) {
+      case Constraint::Order::lt:
+      case Constraint::Order::le:
+        upperDeltaConstraint = std::min(
+            upperDeltaConstraint,
+            Bounds{static_cast<double>(delta.c), {delta.odr == Constraint::Order::le}});
+        // (2, 0) <= (2, 1) + (1, 0)
+        upperEndConstraint =
+            std::min(upperEndConstraint,
+                     upperDeltaConstraint + upperBeginConstraint);
+        // (0, 1) <= (0, 2) + (2, 1)
+        lowerBeginConstraint =
+            std::min(lowerBeginConstraint,
+                     lowerEndConstraint + upperDeltaConstraint);
+        break;
+      case Constraint::Order::gt:
+      case Constraint::Order::ge:
+        lowerDeltaConstraint = std::min(
+            lowerDeltaConstraint,
+            Bounds{static_cast<double>(-delta.c), {delta.odr == Constraint::Order::ge}});
+        // (1, 0) <= (1, 2) + (2, 0)
+        upperBeginConstraint =
+            std::min(upperBeginConstraint,
+                     lowerDeltaConstraint + upperEndConstraint);
+        // (0, 2) <= (0, 1) + (1, 2)
+        lowerEndConstraint =
+            std::min(lowerEndConstraint,
+                     lowerBeginConstraint + lowerDeltaConstraint);
+        break;
+      }
+    }
+  }
+
+  if (!isValidConstraint(upperBeginConstraint,
+                         lowerBeginConstraint) ||
+      !isValidConstraint(upperEndConstraint, lowerEndConstraint) ||
+      !isValidConstraint(upperDeltaConstraint,
+                         lowerDeltaConstraint)) {
+    return false;
+  }
+
+  ansZone.value(0, 1) = std::move(lowerBeginConstraint);
+  ansZone.value(1, 0) = std::move(upperBeginConstraint);
+  ansZone.value(0, 2) = std::move(lowerEndConstraint);
+  ansZone.value(2, 0) = std::move(upperEndConstraint);
+  ansZone.value(1, 2) = std::move(lowerDeltaConstraint);
+  ansZone.value(2, 1) = std::move(upperDeltaConstraint);
+  return true;
+}
+
+/*!
+  @brief Compute the constraint on the beginning t of a matching after a
+  transition at an event
+
+  @param [in] config The configuration before the transition.
+  @param [in] edge The transition.
+  @param [in] t The timestamp of the event.
+  @param [out] upperBeginConstraint The upper bound of t after the transition.
+  @param [out] lowerBeginConstraint The negated lower bound of t after the
+  transition.
+  @returns true if and only if the transition is possible
+ */
+inline bool solveTransition(const IntervalInternalState &config,
+                            const TATransition &edge, double t,
+                            Bounds &upperBeginConstraint,
+                            Bounds &lowerBeginConstraint) {
+  upperBeginConstraint = config.upperConstraint;
+  lowerBeginConstraint = config.lowerConstraint;
+
+  for (const auto &delta : edge.guard) {
+    if (config.resetTime[delta.x]) {
+      if (!delta.satisfy(t - config.resetTime[delta.x])) {
+        return false;
+      }
+    } else {
+      switch (delta.odr) {
+      case Constraint::Order::lt:
+      case Constraint::Order::le:
+        lowerBeginConstraint =
+            std::min(lowerBeginConstraint,
+                     Bounds{delta.c - t,
+                            {delta.odr == Constraint::Order::le}});
+        break;
+      case Constraint::Order::gt:
+      case Constraint::Order::ge:
+        upperBeginConstraint =
+            std::min(upperBeginConstraint,
+                     Bounds{t - delta.c,
+                            {delta.odr == Constraint::Order::ge}});
+        break;
+      }
+    }
+  }
+
+  return isValidConstraint(upperBeginConstraint, lowerBeginConstraint);
+}
+
+/*!
+  @brief Returns the first starting position at or after i from which the m-th
+  event is labelled with an end character.
+
+  The positions skipped cannot be the starting position of any matching. The
+  labels are scanned only for the containers holding the whole timed word in
+  memory, e.g., WordSlice and WordColumns, and i is returned as it is for the
+  other containers.
+ */
+template <class InputContainer>
+std::size_t nextEndCharStart(const WordContainer<InputContainer> &word,
+                             const SundaySkipValue &delta, std::size_t i) {
+  if constexpr (InMemoryContainer<InputContainer>) {
+    const std::size_t last = i + delta.getM() - 1;
+    if (last < word.size()) {
+      return word.findEndChar(delta, last) - (delta.getM() - 1);
+    }
+  }
+  return i;
+}
+
 /*!
   @brief Execute the timed FJS algorithm.
   @param [in] word A container of a timed word representing a log.
-  @param [in] A A timed automaton used as a pattern.
+  @param [in] pattern A pattern compiled in advance.
   @param [out] ans A container for the answer zone.
+  @param [out] counters The counters of the matching loop. If it is nullptr,
+  they are not reported.
 */
 template <class InputContainer, class OutputContainer>
-void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
-           AnsContainer<OutputContainer> &ans) {
+void monaa(WordContainer<InputContainer> word, const CompiledPattern &pattern,
+           AnsContainer<OutputContainer> &ans,
+           MatchCounters *counters = nullptr) {
+  MatchCounters ignored;
+  MatchCounters &count = counters ? *counters : ignored;
+  const TimedAutomaton &A = pattern.automaton;
   // Sunday's Skip value
   // Char -> Skip Value
-  const SundaySkipValue delta = SundaySkipValue(A);
+  const SundaySkipValue &delta = pattern.delta;
   const int m = delta.getM();
-  std::unordered_set<Alphabet> endChars;
-  delta.getEndChars(endChars);
 
   // KMP-Type Skip value
   // A.State -> SkipValue
-  const KMPSkipValue beta(A, m);
+  const KMPSkipValue &beta = pattern.beta;
+
+  // The bounds of the duration of the matchings
+  const MatchDuration &duration = pattern.duration;
+  const double minDuration = duration.getMin();
+  const double maxDuration = duration.getMax();
 
   // main computation
   if (std::all_of(A.states.begin(), A.states.end(),
@@ -167,7 +361,6 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
                     return s->next.find(0) == s->next.end();
                   })) {
     // When there is no epsilon transition
-    // auto start = std::chrono::system_clock::now();
 
     std::size_t i = 0;
     std::vector<std::pair<std::pair<double, bool>, std::pair<double, bool>>>
@@ -232,13 +425,20 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       } else
 #endif
       if (m > 1 && word.fetch(i + m - 1)) {
-        while (endChars.find(word[i + m - 1].first) == endChars.end()) {
+        while (!delta.isEndChar(word[i + m - 1].first)) {
           if (!word.fetch(i + m)) {
             tooLarge = true;
             break;
           }
           // increment i
-          i += delta[word[i + m].first];
+          const std::size_t previousI = i;
+          if (delta.useQGram() && word.fetch(i + m + 1)) {
+            i += delta(word[i + m].first, word[i + m + 1].first);
+          } else {
+            i += delta[word[i + m].first];
+          }
+          i = nextEndCharStart(word, delta, i);
+          count.sundayShift(i - previousI);
           word.setFront(i - 1);
           if (!word.fetch(i + m - 1)) {
             tooLarge = true;
@@ -250,6 +450,21 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       if (tooLarge)
         break;
 
+      // Skip the positions from which the first m events are longer than the
+      // maximum duration. In the signal mode, a matching ends in the segment
+      // of its m-th event, i.e., after the (m - 1)-th event, while it begins
+      // before the first one. Hence, it is longer than word[i + m - 2].second -
+      // word[i].second, and we do not use the timestamp of the m-th event as
+      // in the event mode.
+      if (m > 2) {
+        const std::size_t nextI = duration.nextStart(word, i, i + m - 2);
+        if (nextI > i) {
+          i = nextI;
+          word.setFront(i - 1);
+          continue;
+        }
+      }
+
       // KMP like Matching
       CStates.clear();
       CStates.reserve(A.initialStates.size());
@@ -270,121 +485,37 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       }
       j = i;
       while (!CStates.empty() && word.fetch(j)) {
+        // The matchings reaching here are longer than the maximum duration
+        if (j > i && word[j - 1].second - word[i].second > maxDuration) {
+          break;
+        }
         const Alphabet c = word[j].first;
         const double t = word[j].second;
 
-        // try to go to an accepting state
-        for (const auto &config : CStates) {
-          const TAState *s = config.s;
-          auto it = s->next.find(c);
-          if (it == s->next.end()) {
-            continue;
-          }
-          for (const auto &edge : it->second) {
-            auto target = edge.target;
-            if (!target || !target->isMatch) {
+        // try to go to an accepting state unless the matchings are shorter
+        // than the minimum duration
+        if (word[j].second - (i > 0 ? word[i - 1].second : 0) >=
+            minDuration) {
+          for (const auto &config : CStates) {
+            const TAState *s = config.s;
+            auto it = s->next.find(c);
+            if (it == s->next.end()) {
               continue;
             }
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            Bounds upperEndConstraint = {word[j].second, true};
-            Bounds lowerEndConstraint =
-                ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
-
-            // value(2, 1) <= value(2, 0) + value(0, 1)
-            Bounds upperDeltaConstraint =
-                upperEndConstraint + lowerBeginConstraint;
-            // value(1, 2) <= value(1, 0) + value(0, 2)
-            Bounds lowerDeltaConstraint =
-                std::min(lowerEndConstraint + upperBeginConstraint, zeroBounds);
-
-            auto tmpResetTime = config.resetTime;
-            // solve delta
-            for (const auto &delta : edge.guard) {
-              if (tmpResetTime[delta.x]) {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               Bounds{delta.c + tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::le}});
-                  // (2, 1) <= (2, 0) + (0, 1)
-                  upperDeltaConstraint =
-                      std::min(upperDeltaConstraint,
-                               upperEndConstraint + lowerBeginConstraint);
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               Bounds{-delta.c - tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::ge}});
-                  // (1, 2) <= (1, 0) + (0, 2)
-                  lowerDeltaConstraint =
-                      std::min(lowerDeltaConstraint,
-                               upperBeginConstraint + lowerEndConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperDeltaConstraint = std::min(
-                      upperDeltaConstraint,
-                      Bounds{static_cast<double>(delta.c), {delta.odr == Constraint::Order::le}});
-                  // (2, 0) <= (2, 1) + (1, 0)
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               upperDeltaConstraint + upperBeginConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerDeltaConstraint = std::min(
-                      lowerDeltaConstraint,
-                      Bounds{static_cast<double>(-delta.c), {delta.odr == Constraint::Order::ge}});
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  // (0, 2) <= (0, 1) + (1, 2)
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               lowerBeginConstraint + lowerDeltaConstraint);
-                  break;
-                }
+            for (const auto &edge : it->second) {
+              auto target = edge.target;
+              if (!target || !target->isMatch) {
+                continue;
+              }
+              const Bounds upperEndConstraint = {word[j].second, true};
+              const Bounds lowerEndConstraint =
+                  ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
+              Zone ansZone = Zone::zero(3);
+              if (solveAcceptingTransition(config, edge, upperEndConstraint,
+                                           lowerEndConstraint, ansZone)) {
+                ans.push_back(std::move(ansZone));
               }
             }
-
-            if (!isValidConstraint(upperBeginConstraint,
-                                   lowerBeginConstraint) ||
-                !isValidConstraint(upperEndConstraint, lowerEndConstraint) ||
-                !isValidConstraint(upperDeltaConstraint,
-                                   lowerDeltaConstraint)) {
-              continue;
-            }
-
-            Zone ansZone = Zone::zero(3);
-            ansZone.value(0, 1) = std::move(lowerBeginConstraint);
-            ansZone.value(1, 0) = std::move(upperBeginConstraint);
-            ansZone.value(0, 2) = std::move(lowerEndConstraint);
-            ansZone.value(2, 0) = std::move(upperEndConstraint);
-            ansZone.value(1, 2) = std::move(lowerDeltaConstraint);
-            ansZone.value(2, 1) = std::move(upperDeltaConstraint);
-
-            ans.push_back(std::move(ansZone));
           }
         }
 
@@ -402,38 +533,9 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
               continue;
             }
 
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            bool transitable = true;
-
-            for (const auto &delta : edge.guard) {
-              if (config.resetTime[delta.x]) {
-                if (!delta.satisfy(t - config.resetTime[delta.x])) {
-                  transitable = false;
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               Bounds{delta.c - t,
-                                      {delta.odr == Constraint::Order::le}});
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               Bounds{t - delta.c,
-                                      {delta.odr == Constraint::Order::ge}});
-                  break;
-                }
-              }
-            }
-
-            if (!transitable || !isValidConstraint(upperBeginConstraint,
-                                                   lowerBeginConstraint)) {
+            Bounds upperBeginConstraint, lowerBeginConstraint;
+            if (!solveTransition(config, edge, t, upperBeginConstraint,
+                                 lowerBeginConstraint)) {
               continue;
             }
 
@@ -447,8 +549,10 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
                                  std::move(lowerBeginConstraint));
           }
         }
+        count.expand(CStates.size());
         j++;
       }
+      count.window(j - i);
       if (!word.fetch(j)) {
         LastStates = std::move(CStates);
       }
@@ -459,24 +563,60 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       }
       // increment i
       i += greatestN;
+      count.kmpShift(greatestN);
       word.setFront(i - 1);
     }
-
-    // auto end = std::chrono::system_clock::now();
-    // auto dur = end - start;
-    // auto nsec =
-    // std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
-    //    std::cout << "main computation: " << nsec / 1000000.0 << " ms" <<
-    //    std::endl;
+    count.events = word.size();
   } else {
     // When there are some epsilon transitions
-    // auto start = std::chrono::system_clock::now();
 
     std::size_t i = 0;
     std::array<std::vector<IntermediateZone>, CHAR_MAX> init;
     std::vector<InternalState> CStates;
     std::vector<InternalState> LastStates;
 
+    // The epsilon transitions with a target of each state. We precompute
+    // them so that we look them up only once for each configuration.
+    std::unordered_map<const TAState *, std::vector<const TATransition *>>
+        epsilonTransitions;
+    for (const auto &state : A.states) {
+      auto it = state->next.find(0);
+      if (it == state->next.end()) {
+        continue;
+      }
+      std::vector<const TATransition *> transitions;
+      for (const auto &edge : it->second) {
+        if (edge.target) {
+          transitions.push_back(&edge);
+        }
+      }
+      if (!transitions.empty()) {
+        epsilonTransitions.emplace(state.get(), std::move(transitions));
+      }
+    }
+
+    // The index of the configurations in CStates by the hash of (TAState,
+    // reset time, zone). We use this instead of the linear search in the
+    // epsilon closure.
+    std::unordered_multimap<std::size_t, std::size_t> reached;
+    const auto hashOf = [](const InternalState &config) {
+      std::size_t seed = config.z.hash();
+      boost::hash_combine(seed, config.s);
+      for (const auto &rtime : config.resetTime) {
+        if (const double *p_t = boost::get<double>(&rtime)) {
+          boost::hash_combine(seed, std::hash<double>{}(*p_t));
+        } else {
+          boost::hash_combine(seed, boost::get<ClockVariables>(rtime));
+        }
+      }
+      return seed;
+    };
+    const auto isSameConfig = [](const InternalState &left,
+                                 const InternalState &right) {
+      return left.s == right.s && left.resetTime == right.resetTime &&
+             left.z == right.z;
+    };
+
     // When there can be immidiate accepting
     // @todo This optimization is not yet when we have epsilon transitions
 #if 0
@@ -533,13 +673,20 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       } else
 #endif
       if (m > 1 && word.fetch(i + m - 1)) {
-        while (endChars.find(word[i + m - 1].first) == endChars.end()) {
+        while (!delta.isEndChar(word[i + m - 1].first)) {
           if (!word.fetch(i + m)) {
             tooLarge = true;
             break;
           }
           // increment i
-          i += delta[word[i + m].first];
+          const std::size_t previousI = i;
+          if (delta.useQGram() && word.fetch(i + m + 1)) {
+            i += delta(word[i + m].first, word[i + m + 1].first);
+          } else {
+            i += delta[word[i + m].first];
+          }
+          i = nextEndCharStart(word, delta, i);
+          count.sundayShift(i - previousI);
           word.setFront(i - 1);
           if (!word.fetch(i + m - 1)) {
             tooLarge = true;
@@ -551,6 +698,21 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       if (tooLarge)
         break;
 
+      // Skip the positions from which the first m events are longer than the
+      // maximum duration. In the signal mode, a matching ends in the segment
+      // of its m-th event, i.e., after the (m - 1)-th event, while it begins
+      // before the first one. Hence, it is longer than word[i + m - 2].second -
+      // word[i].second, and we do not use the timestamp of the m-th event as
+      // in the event mode.
+      if (m > 2) {
+        const std::size_t nextI = duration.nextStart(word, i, i + m - 2);
+        if (nextI > i) {
+          i = nextI;
+          word.setFront(i - 1);
+          continue;
+        }
+      }
+
       // KMP like Matching
       CStates.clear();
       if (word.fetch(i)) {
@@ -568,77 +730,88 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       }
       j = i;
       while (!CStates.empty() && word.fetch(j)) {
+        // The matchings reaching here are longer than the maximum duration
+        if (j > i && word[j - 1].second - word[i].second > maxDuration) {
+          break;
+        }
         // try unobservable transitions
 
-        // Correct the states have epsilon transitions
-        std::vector<InternalState> CurrEpsilonConf;
-        CurrEpsilonConf.reserve(CStates.size());
-        for (auto &istate : CStates) {
-          auto it = istate.s->next.find(0);
-          if (it != istate.s->next.end()) {
-            CurrEpsilonConf.push_back(istate);
+        // The configurations reached by epsilon transitions are appended to
+        // CStates and processed in the same loop, i.e., in the breadth-first
+        // order without copying each round.
+        const Bounds epsilonUpperBound = {word[j].second, true};
+        const Bounds epsilonLowerBound =
+            (j > 0) ? Bounds{-word[j - 1].second, false} : Bounds{0, true};
+        // The epsilon transitions may form a cycle, so we skip the
+        // configurations already reached in this step.
+        reached.clear();
+        for (std::size_t k = 0; k < CStates.size(); ++k) {
+          reached.emplace(hashOf(CStates[k]), k);
+        }
+        for (std::size_t k = 0; k < CStates.size(); ++k) {
+          auto it = epsilonTransitions.find(CStates[k].s);
+          if (it == epsilonTransitions.end()) {
+            continue;
+          }
+          // The variable for the time of the epsilon transition does not
+          // depend on the transition, so we allocate it once.
+          IntermediateZone allocatedZ = CStates[k].z;
+          const ClockVariables newClock =
+              allocatedZ.alloc(epsilonUpperBound, epsilonLowerBound);
+          for (const TATransition *edge : it->second) {
+            IntermediateZone tmpZ = allocatedZ;
+            tmpZ.tighten(edge->guard, CStates[k].resetTime);
+            if (tmpZ.isSatisfiableCanonized()) {
+              auto tmpResetTime = CStates[k].resetTime;
+              for (ClockVariables x : edge->resetVars) {
+                tmpResetTime[x] = newClock;
+              }
+              tmpZ.update(tmpResetTime);
+              CStates.emplace_back(edge->target, std::move(tmpResetTime),
+                                   std::move(tmpZ));
+              const std::size_t hash = hashOf(CStates.back());
+              const auto range = reached.equal_range(hash);
+              if (std::any_of(range.first, range.second, [&](const auto &pair) {
+                    return isSameConfig(CStates[pair.second], CStates.back());
+                  })) {
+                CStates.pop_back();
+              } else {
+                reached.emplace(hash, CStates.size() - 1);
+              }
+            }
           }
         }
-        while (!CurrEpsilonConf.empty()) {
-          std::vector<InternalState> PrevEpsilonConf =
-              std::move(CurrEpsilonConf);
-          CurrEpsilonConf.clear();
-          for (const auto &econfig : PrevEpsilonConf) {
-            auto it = econfig.s->next.find(0);
-            if (it == econfig.s->next.end()) {
+
+        const Alphabet c = word[j].first;
+        const double t = word[j].second;
+
+        // try to go to an accepting state unless the matchings are shorter
+        // than the minimum duration
+        if (word[j].second - (i > 0 ? word[i - 1].second : 0) >=
+            minDuration) {
+          for (const auto &config : CStates) {
+            const TAState *s = config.s;
+            auto it = s->next.find(c);
+            if (it == s->next.end()) {
               continue;
             }
             for (const auto &edge : it->second) {
               auto target = edge.target;
-              if (!target) {
+              if (!target || !target->isMatch) {
                 continue;
               }
-              IntermediateZone tmpZ = econfig.z;
-              ClockVariables newClock = 0;
+              IntermediateZone tmpZ = config.z;
               tmpZ.alloc({word[j].second, true},
                          ((j > 0) ? Bounds{-word[j - 1].second, false}
                                   : Bounds{0, true}));
-              tmpZ.tighten(edge.guard, econfig.resetTime);
+              tmpZ.tighten(edge.guard, config.resetTime);
               if (tmpZ.isSatisfiableCanonized()) {
-                auto tmpResetTime = econfig.resetTime;
-                for (ClockVariables x : edge.resetVars) {
-                  tmpResetTime[x] = newClock;
-                }
-                tmpZ.update(tmpResetTime);
-                CurrEpsilonConf.emplace_back(target, tmpResetTime, tmpZ);
+                Zone ansZone;
+                tmpZ.toAns(ansZone);
+                ans.push_back(std::move(ansZone));
               }
             }
           }
-          CStates.insert(CStates.end(), CurrEpsilonConf.begin(),
-                         CurrEpsilonConf.end());
-        }
-
-        const Alphabet c = word[j].first;
-        const double t = word[j].second;
-
-        // try to go to an accepting state
-        for (const auto &config : CStates) {
-          const TAState *s = config.s;
-          auto it = s->next.find(c);
-          if (it == s->next.end()) {
-            continue;
-          }
-          for (const auto &edge : it->second) {
-            auto target = edge.target;
-            if (!target || !target->isMatch) {
-              continue;
-            }
-            IntermediateZone tmpZ = config.z;
-            tmpZ.alloc({word[j].second, true},
-                       ((j > 0) ? Bounds{-word[j - 1].second, false}
-                                : Bounds{0, true}));
-            tmpZ.tighten(edge.guard, config.resetTime);
-            if (tmpZ.isSatisfiableCanonized()) {
-              Zone ansZone;
-              tmpZ.toAns(ansZone);
-              ans.push_back(std::move(ansZone));
-            }
-          }
         }
 
         // try observable transitios (usual)
@@ -667,8 +840,10 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
             }
           }
         }
+        count.expand(CStates.size());
         j++;
       }
+      count.window(j - i);
       if (!word.fetch(j)) {
         LastStates = std::move(CStates);
       }
@@ -679,64 +854,56 @@ void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
       }
       // increment i
       i += greatestN;
+      count.kmpShift(greatestN);
       word.setFront(i - 1);
     }
-
-    // auto end = std::chrono::system_clock::now();
-    // auto dur = end - start;
-    // auto nsec =
-    // std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
-    //    std::cout << "main computation: " << nsec / 1000000.0 << " ms" <<
-    //    std::endl;
+    count.events = word.size();
   }
 }
 
 /*!
-  @brief Execute the timed FJS algorithm. This is the original timed FJS
-  algorithm
+  @brief Execute the timed FJS algorithm.
   @param [in] word A container of a timed word representing a log.
   @param [in] A A timed automaton used as a pattern.
   @param [out] ans A container for the answer zone.
 */
 template <class InputContainer, class OutputContainer>
-void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
-                 AnsContainer<OutputContainer> &ans) {
-  TimedAutomaton Ap;
-  Ap.states.reserve(A.states.size());
-  Ap.initialStates.reserve(A.initialStates.size());
-  Ap.maxConstraints = A.maxConstraints;
-  std::unordered_map<const TAState *, std::shared_ptr<TAState>> ptrConv;
-  for (std::shared_ptr<TAState> s : A.states) {
-    ptrConv[s.get()] = std::make_shared<TAState>(*s);
-    Ap.states.push_back(ptrConv.at(s.get()));
-    if (std::binary_search(A.initialStates.begin(), A.initialStates.end(), s)) {
-      Ap.initialStates.push_back(ptrConv.at(s.get()));
-    }
-  }
+void monaa(WordContainer<InputContainer> word, TimedAutomaton A,
+           AnsContainer<OutputContainer> &ans) {
+  monaa(std::move(word), CompiledPattern(std::move(A), CompiledPattern::Mode::signal),
+        ans);
+}
 
-  for (std::shared_ptr<TAState> s : Ap.states) {
-    if (s->next.find('$') != s->next.end()) {
-      s->isMatch = true;
-      s->next['$'].clear();
-      s->next.erase('$');
-    }
-    for (auto &transitionsPair : s->next) {
-      for (auto &transition : transitionsPair.second) {
-        transition.target = ptrConv.at(transition.target).get();
-      }
-    }
-  }
+/*!
+  @brief The main loop of @link monaaDollar @endlink
 
+  @param [in] word A container of a timed word representing a log.
+  @param [in] pattern A pattern compiled in advance.
+  @param [in] accept The function called with the accepting state and the
+  answer zone of each matching. The zone is overwritten after the call.
+  @param [out] counters The counters of the matching loop. If it is nullptr,
+  they are not reported.
+*/
+template <class InputContainer, class Accept>
+void monaaDollarLoop(WordContainer<InputContainer> word,
+                     const CompiledPattern &pattern, Accept &&accept,
+                     MatchCounters *counters = nullptr) {
+  MatchCounters ignored;
+  MatchCounters &count = counters ? *counters : ignored;
+  const TimedAutomaton &A = pattern.automaton;
   // Sunday's Skip value
   // Char -> Skip Value
-  const SundaySkipValue delta = SundaySkipValue(Ap);
+  const SundaySkipValue &delta = pattern.delta;
   const int m = delta.getM();
-  std::unordered_set<Alphabet> endChars;
-  delta.getEndChars(endChars);
 
   // KMP-Type Skip value
   // A.State -> SkipValue
-  const KMPSkipValue beta(Ap, m);
+  const KMPSkipValue &beta = pattern.beta;
+
+  // The bounds of the duration of the matchings
+  const MatchDuration &duration = pattern.duration;
+  const double minDuration = duration.getMin();
+  const double maxDuration = duration.getMax();
 
   // main computation
   if (std::all_of(A.states.begin(), A.states.end(),
@@ -751,6 +918,8 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
     std::vector<IntervalInternalState> CStates;
     std::vector<IntervalInternalState> LastStates;
     const Bounds zeroBounds = {0, true};
+    // The answer zone is overwritten for each matching
+    Zone ansZone = Zone::zero(3);
 
     // When there can be immidiate accepting
     // @todo This optimization is not yet when we have epsilon transitions
@@ -775,7 +944,6 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
     }
 #endif
 
-    ans.clear();
     std::size_t j;
     while (word.fetch(i + m - 1)) {
       bool tooLarge = false;
@@ -808,13 +976,20 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
       } else
 #endif
       if (m > 1 && word.fetch(i + m - 1)) {
-        while (endChars.find(word[i + m - 1].first) == endChars.end()) {
+        while (!delta.isEndChar(word[i + m - 1].first)) {
           if (!word.fetch(i + m)) {
             tooLarge = true;
             break;
           }
           // increment i
-          i += delta[word[i + m].first];
+          const std::size_t previousI = i;
+          if (delta.useQGram() && word.fetch(i + m + 1)) {
+            i += delta(word[i + m].first, word[i + m + 1].first);
+          } else {
+            i += delta[word[i + m].first];
+          }
+          i = nextEndCharStart(word, delta, i);
+          count.sundayShift(i - previousI);
           word.setFront(i - 1);
           if (!word.fetch(i + m - 1)) {
             tooLarge = true;
@@ -826,6 +1001,17 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
       if (tooLarge)
         break;
 
+      // Skip the positions from which the first m events are longer than the
+      // maximum duration
+      if (m > 1) {
+        const std::size_t nextI = duration.nextStart(word, i, i + m - 1);
+        if (nextI > i) {
+          i = nextI;
+          word.setFront(i - 1);
+          continue;
+        }
+      }
+
       // KMP like Matching
       CStates.clear();
       CStates.reserve(A.initialStates.size());
@@ -846,121 +1032,36 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
       }
       j = i;
       while (!CStates.empty() && word.fetch(j)) {
+        // The matchings reaching here are longer than the maximum duration
+        if (j > i && word[j - 1].second - word[i].second > maxDuration) {
+          break;
+        }
         const Alphabet c = word[j].first;
         const double t = word[j].second;
 
-        // try to go to an accepting state
-        for (const auto &config : CStates) {
-          const TAState *s = config.s;
-          auto it = s->next.find('$');
-          if (it == s->next.end()) {
-            continue;
-          }
-          for (const auto &edge : it->second) {
-            auto target = edge.target;
-            if (!target || !target->isMatch) {
+        // try to go to an accepting state unless the matchings are shorter
+        // than the minimum duration
+        if (word[j].second - (i > 0 ? word[i - 1].second : 0) >=
+            minDuration) {
+          for (const auto &config : CStates) {
+            const TAState *s = config.s;
+            auto it = s->next.find('$');
+            if (it == s->next.end()) {
               continue;
             }
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            Bounds upperEndConstraint = {word[j].second, true};
-            Bounds lowerEndConstraint =
-                ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
-
-            // value(2, 1) <= value(2, 0) + value(0, 1)
-            Bounds upperDeltaConstraint =
-                upperEndConstraint + lowerBeginConstraint;
-            // value(1, 2) <= value(1, 0) + value(0, 2)
-            Bounds lowerDeltaConstraint =
-                std::min(lowerEndConstraint + upperBeginConstraint, zeroBounds);
-
-            auto tmpResetTime = config.resetTime;
-            // solve delta
-            for (const auto &delta : edge.guard) {
-              if (tmpResetTime[delta.x]) {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               Bounds{delta.c + tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::le}});
-                  // (2, 1) <= (2, 0) + (0, 1)
-                  upperDeltaConstraint =
-                      std::min(upperDeltaConstraint,
-                               upperEndConstraint + lowerBeginConstraint);
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               Bounds{-delta.c - tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::ge}});
-                  // (1, 2) <= (1, 0) + (0, 2)
-                  lowerDeltaConstraint =
-                      std::min(lowerDeltaConstraint,
-                               upperBeginConstraint + lowerEndConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperDeltaConstraint = std::min(
-                      upperDeltaConstraint,
-                      Bounds{static_cast<double>(delta.c), {delta.odr == Constraint::Order::le}});
-                  // (2, 0) <= (2, 1) + (1, 0)
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               upperDeltaConstraint + upperBeginConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerDeltaConstraint = std::min(
-                      lowerDeltaConstraint,
-                      Bounds{static_cast<double>(-delta.c), {delta.odr == Constraint::Order::ge}});
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  // (0, 2) <= (0, 1) + (1, 2)
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               lowerBeginConstraint + lowerDeltaConstraint);
-                  break;
-                }
+            for (const auto &edge : it->second) {
+              auto target = edge.target;
+              if (!target || !target->isMatch) {
+                continue;
+              }
+              const Bounds upperEndConstraint = {word[j].second, true};
+              const Bounds lowerEndConstraint =
+                  ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
+              if (solveAcceptingTransition(config, edge, upperEndConstraint,
+                                           lowerEndConstraint, ansZone)) {
+                accept(target, ansZone);
               }
             }
-
-            if (!isValidConstraint(upperBeginConstraint,
-                                   lowerBeginConstraint) ||
-                !isValidConstraint(upperEndConstraint, lowerEndConstraint) ||
-                !isValidConstraint(upperDeltaConstraint,
-                                   lowerDeltaConstraint)) {
-              continue;
-            }
-
-            Zone ansZone = Zone::zero(3);
-            ansZone.value(0, 1) = std::move(lowerBeginConstraint);
-            ansZone.value(1, 0) = std::move(upperBeginConstraint);
-            ansZone.value(0, 2) = std::move(lowerEndConstraint);
-            ansZone.value(2, 0) = std::move(upperEndConstraint);
-            ansZone.value(1, 2) = std::move(lowerDeltaConstraint);
-            ansZone.value(2, 1) = std::move(upperDeltaConstraint);
-
-            ans.push_back(std::move(ansZone));
           }
         }
 
@@ -978,38 +1079,9 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
               continue;
             }
 
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            bool transitable = true;
-
-            for (const auto &delta : edge.guard) {
-              if (config.resetTime[delta.x]) {
-                if (!delta.satisfy(t - config.resetTime[delta.x])) {
-                  transitable = false;
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               Bounds{delta.c - t,
-                                      {delta.odr == Constraint::Order::le}});
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               Bounds{t - delta.c,
-                                      {delta.odr == Constraint::Order::ge}});
-                  break;
-                }
-              }
-            }
-
-            if (!transitable || !isValidConstraint(upperBeginConstraint,
-                                                   lowerBeginConstraint)) {
+            Bounds upperBeginConstraint, lowerBeginConstraint;
+            if (!solveTransition(config, edge, t, upperBeginConstraint,
+                                 lowerBeginConstraint)) {
               continue;
             }
 
@@ -1023,8 +1095,10 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
                                  std::move(lowerBeginConstraint));
           }
         }
+        count.expand(CStates.size());
         j++;
       }
+      count.window(j - i);
       if (!word.fetch(j)) {
         // try to go to an accepting state
         for (const auto &config : CStates) {
@@ -1038,107 +1112,14 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
             if (!target || !target->isMatch) {
               continue;
             }
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            Bounds upperEndConstraint = {
+            const Bounds upperEndConstraint = {
                 std::numeric_limits<double>::infinity(), true};
-            Bounds lowerEndConstraint =
+            const Bounds lowerEndConstraint =
                 ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
-
-            // value(2, 1) <= value(2, 0) + value(0, 1)
-            Bounds upperDeltaConstraint =
-                upperEndConstraint + lowerBeginConstraint;
-            // value(1, 2) <= value(1, 0) + value(0, 2)
-            Bounds lowerDeltaConstraint =
-                std::min(lowerEndConstraint + upperBeginConstraint, zeroBounds);
-
-            auto tmpResetTime = config.resetTime;
-            // solve delta
-            for (const auto &delta : edge.guard) {
-              if (tmpResetTime[delta.x]) {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               Bounds{delta.c + tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::le}});
-                  // (2, 1) <= (2, 0) + (0, 1)
-                  upperDeltaConstraint =
-                      std::min(upperDeltaConstraint,
-                               upperEndConstraint + lowerBeginConstraint);
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               Bounds{-delta.c - tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::ge}});
-                  // (1, 2) <= (1, 0) + (0, 2)
-                  lowerDeltaConstraint =
-                      std::min(lowerDeltaConstraint,
-                               upperBeginConstraint + lowerEndConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperDeltaConstraint = std::min(
-                      upperDeltaConstraint,
-                      Bounds{static_cast<double>(delta.c), {delta.odr == Constraint::Order::le}});
-                  // (2, 0) <= (2, 1) + (1, 0)
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               upperDeltaConstraint + upperBeginConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerDeltaConstraint = std::min(
-                      lowerDeltaConstraint,
-                      Bounds{static_cast<double>(-delta.c), {delta.odr == Constraint::Order::ge}});
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  // (0, 2) <= (0, 1) + (1, 2)
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               lowerBeginConstraint + lowerDeltaConstraint);
-                  break;
-                }
-              }
-            }
-
-            if (!isValidConstraint(upperBeginConstraint,
-                                   lowerBeginConstraint) ||
-                !isValidConstraint(upperEndConstraint, lowerEndConstraint) ||
-                !isValidConstraint(upperDeltaConstraint,
-                                   lowerDeltaConstraint)) {
-              continue;
+            if (solveAcceptingTransition(config, edge, upperEndConstraint,
+                                         lowerEndConstraint, ansZone)) {
+              accept(target, ansZone);
             }
-
-            Zone ansZone = Zone::zero(3);
-            ansZone.value(0, 1) = std::move(lowerBeginConstraint);
-            ansZone.value(1, 0) = std::move(upperBeginConstraint);
-            ansZone.value(0, 2) = std::move(lowerEndConstraint);
-            ansZone.value(2, 0) = std::move(upperEndConstraint);
-            ansZone.value(1, 2) = std::move(lowerDeltaConstraint);
-            ansZone.value(2, 1) = std::move(upperDeltaConstraint);
-
-            ans.push_back(std::move(ansZone));
           }
         }
         LastStates = std::move(CStates);
@@ -1146,65 +1127,112 @@ void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
       // KMP like skip value
       int greatestN = 1;
       for (const IntervalInternalState &istate : LastStates) {
-        greatestN = std::max(beta[ptrConv.at(istate.s).get()], greatestN);
+        greatestN = std::max(beta[istate.s], greatestN);
       }
       // increment i
       i += greatestN;
+      count.kmpShift(greatestN);
       word.setFront(i - 1);
     }
+    count.events = word.size();
   } else {
   }
 }
 
 /*!
-  @brief Execute the timed FJS algorithm.
+  @brief Execute the timed FJS algorithm. This is the original timed FJS
+  algorithm
+  @param [in] word A container of a timed word representing a log.
+  @param [in] pattern A pattern compiled in advance.
+  @param [out] ans A container for the answer zone.
+  @param [out] counters The counters of the matching loop. If it is nullptr,
+  they are not reported.
+*/
+template <class InputContainer, class OutputContainer>
+void monaaDollar(WordContainer<InputContainer> word,
+                 const CompiledPattern &pattern,
+                 AnsContainer<OutputContainer> &ans,
+                 MatchCounters *counters = nullptr) {
+  ans.clear();
+  monaaDollarLoop(
+      std::move(word), pattern,
+      [&ans](const TAState *, const Zone &ansZone) { ans.push_back(ansZone); },
+      counters);
+}
+
+/*!
+  @brief Execute the timed FJS algorithm. This is the original timed FJS
+  algorithm
   @param [in] word A container of a timed word representing a log.
   @param [in] A A timed automaton used as a pattern.
   @param [out] ans A container for the answer zone.
+*/
+template <class InputContainer, class OutputContainer>
+void monaaDollar(WordContainer<InputContainer> word, TimedAutomaton A,
+                 AnsContainer<OutputContainer> &ans) {
+  monaaDollar(std::move(word), CompiledPattern(std::move(A), CompiledPattern::Mode::event),
+              ans);
+}
+
+/*!
+  @brief Execute the timed FJS algorithm with many patterns merged into one.
+
+  The log is scanned once with the skip values of the merged pattern, and the
+  answer zone of each matching is pushed to the container of the pattern of
+  its accepting state. The answer zones of each pattern are the same as @link
+  monaaDollar @endlink with the pattern, including the order.
+
+  @param [in] word A container of a timed word representing a log.
+  @param [in] merged The patterns merged and compiled in advance. It must be
+  compiled for the event mode.
+  @param [out] ans The containers for the answer zones, e.g., AnsVec or
+  AnsPrinter. ans[k] is for the k-th pattern.
+  @param [out] counters The counters of the matching loop. If it is nullptr,
+  they are not reported.
+  @pre ans.size() == merged.patternSize
+*/
+template <class InputContainer, class Answer>
+void monaaMerged(WordContainer<InputContainer> word,
+                 const MergedPattern &merged, std::vector<Answer> &ans,
+                 MatchCounters *counters = nullptr) {
+  for (auto &patternAns : ans) {
+    patternAns.clear();
+  }
+  monaaDollarLoop(
+      std::move(word), merged.pattern,
+      [&](const TAState *target, const Zone &ansZone) {
+        ans[merged.tags.at(target)].push_back(ansZone);
+      },
+      counters);
+}
+
+/*!
+  @brief Execute the timed FJS algorithm.
+  @param [in] word A container of a timed word representing a log.
+  @param [in] pattern A pattern compiled in advance.
+  @param [out] ans A container for the answer zone.
 
   @note The labels of the transitions to the accepting states are not necessary
   $
 */
 template <class InputContainer, class OutputContainer>
 void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
-                             TimedAutomaton A,
+                             const CompiledPattern &pattern,
                              AnsContainer<OutputContainer> &ans) {
-  TimedAutomaton Ap;
-  Ap.states.reserve(A.states.size());
-  Ap.initialStates.reserve(A.initialStates.size());
-  Ap.maxConstraints = A.maxConstraints;
-  std::unordered_map<const TAState *, std::shared_ptr<TAState>> ptrConv;
-  for (std::shared_ptr<TAState> s : A.states) {
-    ptrConv[s.get()] = std::make_shared<TAState>(*s);
-    Ap.states.push_back(ptrConv[s.get()]);
-    if (std::binary_search(A.initialStates.begin(), A.initialStates.end(), s)) {
-      Ap.initialStates.push_back(ptrConv[s.get()]);
-    }
-  }
-
-  for (std::shared_ptr<TAState> s : Ap.states) {
-    if (s->next.find('$') != s->next.end()) {
-      s->isMatch = true;
-      s->next['$'].clear();
-      s->next.erase('$');
-    }
-    for (auto &transitionsPair : s->next) {
-      for (auto &transition : transitionsPair.second) {
-        transition.target = ptrConv[transition.target].get();
-      }
-    }
-  }
-
+  const TimedAutomaton &A = pattern.automaton;
   // Sunday's Skip value
   // Char -> Skip Value
-  const SundaySkipValue delta = SundaySkipValue(Ap);
+  const SundaySkipValue &delta = pattern.delta;
   const int m = delta.getM();
-  std::unordered_set<Alphabet> endChars;
-  delta.getEndChars(endChars);
 
   // KMP-Type Skip value
   // A.State -> SkipValue
-  const KMPSkipValue beta(Ap, m);
+  const KMPSkipValue &beta = pattern.beta;
+
+  // The bounds of the duration of the matchings
+  const MatchDuration &duration = pattern.duration;
+  const double minDuration = duration.getMin();
+  const double maxDuration = duration.getMax();
 
   // main computation
   if (std::all_of(A.states.begin(), A.states.end(),
@@ -1276,13 +1304,18 @@ void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
       } else
 #endif
       if (m > 1 && word.fetch(i + m - 1)) {
-        while (endChars.find(word[i + m - 1].first) == endChars.end()) {
+        while (!delta.isEndChar(word[i + m - 1].first)) {
           if (!word.fetch(i + m)) {
             tooLarge = true;
             break;
           }
           // increment i
-          i += delta[word[i + m].first];
+          if (delta.useQGram() && word.fetch(i + m + 1)) {
+            i += delta(word[i + m].first, word[i + m + 1].first);
+          } else {
+            i += delta[word[i + m].first];
+          }
+          i = nextEndCharStart(word, delta, i);
           word.setFront(i - 1);
           if (!word.fetch(i + m - 1)) {
             tooLarge = true;
@@ -1294,6 +1327,17 @@ void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
       if (tooLarge)
         break;
 
+      // Skip the positions from which the first m events are longer than the
+      // maximum duration
+      if (m > 1) {
+        const std::size_t nextI = duration.nextStart(word, i, i + m - 1);
+        if (nextI > i) {
+          i = nextI;
+          word.setFront(i - 1);
+          continue;
+        }
+      }
+
       // KMP like Matching
       CStates.clear();
       CStates.reserve(A.initialStates.size());
@@ -1314,121 +1358,37 @@ void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
       }
       j = i;
       while (!CStates.empty() && word.fetch(j)) {
+        // The matchings reaching here are longer than the maximum duration
+        if (j > i && word[j - 1].second - word[i].second > maxDuration) {
+          break;
+        }
         const Alphabet c = word[j].first;
         const double t = word[j].second;
 
-        // try to go to an accepting state
-        for (const auto &config : CStates) {
-          const TAState *s = config.s;
-          auto it = s->next.find('$');
-          if (it == s->next.end()) {
-            continue;
-          }
-          for (const auto &edge : it->second) {
-            auto target = edge.target;
-            if (!target || !target->isMatch) {
+        // try to go to an accepting state unless the matchings are shorter
+        // than the minimum duration
+        if (word[j].second - (i > 0 ? word[i - 1].second : 0) >=
+            minDuration) {
+          for (const auto &config : CStates) {
+            const TAState *s = config.s;
+            auto it = s->next.find('$');
+            if (it == s->next.end()) {
               continue;
             }
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            Bounds upperEndConstraint = {word[j].second, true};
-            Bounds lowerEndConstraint =
-                ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
-
-            // value(2, 1) <= value(2, 0) + value(0, 1)
-            Bounds upperDeltaConstraint =
-                upperEndConstraint + lowerBeginConstraint;
-            // value(1, 2) <= value(1, 0) + value(0, 2)
-            Bounds lowerDeltaConstraint =
-                std::min(lowerEndConstraint + upperBeginConstraint, zeroBounds);
-
-            auto tmpResetTime = config.resetTime;
-            // solve delta
-            for (const auto &delta : edge.guard) {
-              if (tmpResetTime[delta.x]) {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               Bounds{delta.c + tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::le}});
-                  // (2, 1) <= (2, 0) + (0, 1)
-                  upperDeltaConstraint =
-                      std::min(upperDeltaConstraint,
-                               upperEndConstraint + lowerBeginConstraint);
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               Bounds{-delta.c - tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::ge}});
-                  // (1, 2) <= (1, 0) + (0, 2)
-                  lowerDeltaConstraint =
-                      std::min(lowerDeltaConstraint,
-                               upperBeginConstraint + lowerEndConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperDeltaConstraint = std::min(
-                      upperDeltaConstraint,
-                      Bounds{static_cast<double>(delta.c), {delta.odr == Constraint::Order::le}});
-                  // (2, 0) <= (2, 1) + (1, 0)
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               upperDeltaConstraint + upperBeginConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerDeltaConstraint = std::min(
-                      lowerDeltaConstraint,
-                      Bounds{static_cast<double>(-delta.c), {delta.odr == Constraint::Order::ge}});
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  // (0, 2) <= (0, 1) + (1, 2)
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               lowerBeginConstraint + lowerDeltaConstraint);
-                  break;
-                }
+            for (const auto &edge : it->second) {
+              auto target = edge.target;
+              if (!target || !target->isMatch) {
+                continue;
+              }
+              const Bounds upperEndConstraint = {word[j].second, true};
+              const Bounds lowerEndConstraint =
+                  ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
+              Zone ansZone = Zone::zero(3);
+              if (solveAcceptingTransition(config, edge, upperEndConstraint,
+                                           lowerEndConstraint, ansZone)) {
+                ans.push_back(std::move(ansZone));
               }
             }
-
-            if (!isValidConstraint(upperBeginConstraint,
-                                   lowerBeginConstraint) ||
-                !isValidConstraint(upperEndConstraint, lowerEndConstraint) ||
-                !isValidConstraint(upperDeltaConstraint,
-                                   lowerDeltaConstraint)) {
-              continue;
-            }
-
-            Zone ansZone = Zone::zero(3);
-            ansZone.value(0, 1) = std::move(lowerBeginConstraint);
-            ansZone.value(1, 0) = std::move(upperBeginConstraint);
-            ansZone.value(0, 2) = std::move(lowerEndConstraint);
-            ansZone.value(2, 0) = std::move(upperEndConstraint);
-            ansZone.value(1, 2) = std::move(lowerDeltaConstraint);
-            ansZone.value(2, 1) = std::move(upperDeltaConstraint);
-
-            ans.push_back(std::move(ansZone));
           }
         }
 
@@ -1446,38 +1406,9 @@ void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
               continue;
             }
 
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            bool transitable = true;
-
-            for (const auto &delta : edge.guard) {
-              if (config.resetTime[delta.x]) {
-                if (!delta.satisfy(t - config.resetTime[delta.x])) {
-                  transitable = false;
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               Bounds{delta.c - t,
-                                      {delta.odr == Constraint::Order::le}});
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               Bounds{t - delta.c,
-                                      {delta.odr == Constraint::Order::ge}});
-                  break;
-                }
-              }
-            }
-
-            if (!transitable || !isValidConstraint(upperBeginConstraint,
-                                                   lowerBeginConstraint)) {
+            Bounds upperBeginConstraint, lowerBeginConstraint;
+            if (!solveTransition(config, edge, t, upperBeginConstraint,
+                                 lowerBeginConstraint)) {
               continue;
             }
 
@@ -1542,107 +1473,15 @@ void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
             if (!target || !target->isMatch) {
               continue;
             }
-            Bounds upperBeginConstraint = config.upperConstraint;
-            Bounds lowerBeginConstraint = config.lowerConstraint;
-            Bounds upperEndConstraint = {
+            const Bounds upperEndConstraint = {
                 std::numeric_limits<double>::infinity(), true};
-            Bounds lowerEndConstraint =
+            const Bounds lowerEndConstraint =
                 ((j > 0) ? Bounds{-word[j - 1].second, false} : zeroBounds);
-
-            // value(2, 1) <= value(2, 0) + value(0, 1)
-            Bounds upperDeltaConstraint =
-                upperEndConstraint + lowerBeginConstraint;
-            // value(1, 2) <= value(1, 0) + value(0, 2)
-            Bounds lowerDeltaConstraint =
-                std::min(lowerEndConstraint + upperBeginConstraint, zeroBounds);
-
-            auto tmpResetTime = config.resetTime;
-            // solve delta
-            for (const auto &delta : edge.guard) {
-              if (tmpResetTime[delta.x]) {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               Bounds{delta.c + tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::le}});
-                  // (2, 1) <= (2, 0) + (0, 1)
-                  upperDeltaConstraint =
-                      std::min(upperDeltaConstraint,
-                               upperEndConstraint + lowerBeginConstraint);
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               Bounds{-delta.c - tmpResetTime[delta.x],
-                                      {delta.odr == Constraint::Order::ge}});
-                  // (1, 2) <= (1, 0) + (0, 2)
-                  lowerDeltaConstraint =
-                      std::min(lowerDeltaConstraint,
-                               upperBeginConstraint + lowerEndConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                }
-              } else {
-                switch (delta.odr) {
-                case Constraint::Order::lt:
-                case Constraint::Order::le:
-                  upperDeltaConstraint = std::min(
-                      upperDeltaConstraint,
-                      Bounds{static_cast<double>(delta.c), {delta.odr == Constraint::Order::le}});
-                  // (2, 0) <= (2, 1) + (1, 0)
-                  upperEndConstraint =
-                      std::min(upperEndConstraint,
-                               upperDeltaConstraint + upperBeginConstraint);
-                  // (0, 1) <= (0, 2) + (2, 1)
-                  lowerBeginConstraint =
-                      std::min(lowerBeginConstraint,
-                               lowerEndConstraint + upperDeltaConstraint);
-                  break;
-                case Constraint::Order::gt:
-                case Constraint::Order::ge:
-                  lowerDeltaConstraint = std::min(
-                      lowerDeltaConstraint,
-                      Bounds{static_cast<double>(-delta.c), {delta.odr == Constraint::Order::ge}});
-                  // (1, 0) <= (1, 2) + (2, 0)
-                  upperBeginConstraint =
-                      std::min(upperBeginConstraint,
-                               lowerDeltaConstraint + upperEndConstraint);
-                  // (0, 2) <= (0, 1) + (1, 2)
-                  lowerEndConstraint =
-                      std::min(lowerEndConstraint,
-                               lowerBeginConstraint + lowerDeltaConstraint);
-                  break;
-                }
-              }
-            }
-
-            if (!isValidConstraint(upperBeginConstraint,
-                                   lowerBeginConstraint) ||
-                !isValidConstraint(upperEndConstraint, lowerEndConstraint) ||
-                !isValidConstraint(upperDeltaConstraint,
-                                   lowerDeltaConstraint)) {
-              continue;
-            }
-
             Zone ansZone = Zone::zero(3);
-            ansZone.value(0, 1) = std::move(lowerBeginConstraint);
-            ansZone.value(1, 0) = std::move(upperBeginConstraint);
-            ansZone.value(0, 2) = std::move(lowerEndConstraint);
-            ansZone.value(2, 0) = std::move(upperEndConstraint);
-            ansZone.value(1, 2) = std::move(lowerDeltaConstraint);
-            ansZone.value(2, 1) = std::move(upperDeltaConstraint);
-
-            ans.push_back(std::move(ansZone));
+            if (solveAcceptingTransition(config, edge, upperEndConstraint,
+                                         lowerEndConstraint, ansZone)) {
+              ans.push_back(std::move(ansZone));
+            }
           }
         }
         LastStates = std::move(CStates);
@@ -1650,7 +1489,7 @@ void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
       // KMP like skip value
       int greatestN = 1;
       for (const IntervalInternalState &istate : LastStates) {
-        greatestN = std::max(beta[ptrConv[istate.s].get()], greatestN);
+        greatestN = std::max(beta[istate.s], greatestN);
       }
       // increment i
       i += greatestN;
@@ -1659,3 +1498,17 @@ void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
   } else {
   }
 }
+
+/*!
+  @brief Execute the timed FJS algorithm.
+  @param [in] word A container of a timed word representing a log.
+  @param [in] A A timed automaton used as a pattern.
+  @param [out] ans A container for the answer zone.
+*/
+template <class InputContainer, class OutputContainer>
+void monaaNotNecessaryDollar(WordContainer<InputContainer> word,
+                             TimedAutomaton A,
+                             AnsContainer<OutputContainer> &ans) {
+  monaaNotNecessaryDollar(std::move(word), CompiledPattern(std::move(A), CompiledPattern::Mode::event),
+                          ans);
+}
@@ -0,0 +1,216 @@
+#include "monaa_c.h"
+
+#include <deque>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "batch_monaa.hh"
+#include "online_monitor.hh"
+#include "state_minimization.hh"
+#include "timed_automaton_parser.hh"
+#include "tre_driver.hh"
+
+struct monaa_pattern {
+  // Shared with the matchers so that they do not copy the skip values
+  std::shared_ptr<const CompiledPattern> pattern;
+};
+
+namespace {
+  monaa_interval toInterval(const Bounds &lower, const Bounds &upper) {
+    return {-lower.first, upper.first, lower.second, upper.second};
+  }
+
+  monaa_match toMatch(const Zone &zone) {
+    return {toInterval(zone.value(0, 1), zone.value(1, 0)), toInterval(zone.value(0, 2), zone.value(2, 0)),
+            toInterval(zone.value(1, 2), zone.value(2, 1))};
+  }
+
+  // The same as BufferContainer but for the array of monaa_match
+  class MatchBuffer {
+  private:
+    monaa_match *first;
+    std::size_t capacity;
+    std::size_t count = 0;
+
+  public:
+    MatchBuffer(monaa_match *first, std::size_t capacity) : first(first), capacity(capacity) {}
+    std::size_t size() const { return count; }
+    void push_back(const Zone &ans) {
+      if (count < capacity) {
+        first[count] = toMatch(ans);
+      }
+      count++;
+    }
+    void clear() { count = 0; }
+    void reserve(std::size_t) {}
+    using value_type = Zone;
+  };
+}
+
+struct monaa_matcher {
+  std::deque<monaa_match> matches;
+  OnlineMonitor monitor;
+  bool isFinished = false;
+
+  explicit monaa_matcher(std::shared_ptr<const CompiledPattern> pattern)
+      : monitor(std::move(pattern), [this](const Zone &zone) { matches.push_back(toMatch(zone)); }) {}
+};
+
+namespace {
+  thread_local std::string lastError;
+
+  // Run f and record the reason if it throws
+  template <class Function> bool record(Function &&f) {
+    try {
+      f();
+      return true;
+    } catch (const std::exception &e) {
+      lastError = e.what();
+    } catch (...) {
+      lastError = "unknown error";
+    }
+    return false;
+  }
+
+  // Throw if a handle or a pointer to an output is NULL
+  void requireNonNull(const void *pointer, const char *name) {
+    if (!pointer) {
+      throw std::invalid_argument(std::string(name) + " is NULL");
+    }
+  }
+
+  // Throw if an array of a positive size is NULL
+  void requireArray(const void *pointer, std::size_t size, const char *name) {
+    if (size > 0) {
+      requireNonNull(pointer, name);
+    }
+  }
+
+  monaa_pattern *compile(TimedAutomaton &TA) {
+    minimizeStates(TA);
+    return new monaa_pattern{std::make_shared<const CompiledPattern>(TA, CompiledPattern::Mode::event)};
+  }
+}
+
+extern "C" {
+
+const char *monaa_last_error(void) { return lastError.c_str(); }
+
+monaa_pattern *monaa_pattern_compile_tre(const char *expression) {
+  monaa_pattern *result = nullptr;
+  record([&] {
+    requireNonNull(expression, "expression");
+    TREDriver driver;
+    std::stringstream treStream;
+    treStream << expression;
+    if (!driver.parse(treStream)) {
+      throw std::invalid_argument("Failed to parse TRE");
+    }
+    TimedAutomaton TA;
+    driver.getResult()->toEventTA(TA);
+    result = compile(TA);
+  });
+  return result;
+}
+
+monaa_pattern *monaa_pattern_compile_dot(const char *dot) {
+  monaa_pattern *result = nullptr;
+  record([&] {
+    requireNonNull(dot, "dot");
+    std::stringstream taStream(dot);
+    BoostTimedAutomaton BoostTA;
+    parseBoostTA(taStream, BoostTA);
+    TimedAutomaton TA;
+    convBoostTA(BoostTA, TA);
+    result = compile(TA);
+  });
+  return result;
+}
+
+monaa_pattern *monaa_pattern_load(const char *fileName) {
+  monaa_pattern *result = nullptr;
+  record([&] {
+    requireNonNull(fileName, "fileName");
+    auto pattern = loadCompiledPattern(fileName);
+    if (pattern->mode != CompiledPattern::Mode::event) {
+      throw std::invalid_argument("the compiled pattern is not for the event mode");
+    }
+    result = new monaa_pattern{std::move(pattern)};
+  });
+  return result;
+}
+
+void monaa_pattern_free(monaa_pattern *pattern) { delete pattern; }
+
+monaa_matcher *monaa_matcher_new(const monaa_pattern *pattern) {
+  monaa_matcher *result = nullptr;
+  record([&] {
+    requireNonNull(pattern, "pattern");
+    result = new monaa_matcher(pattern->pattern);
+  });
+  return result;
+}
+
+void monaa_matcher_free(monaa_matcher *matcher) { delete matcher; }
+
+int monaa_matcher_feed(monaa_matcher *matcher, const char *events, const double *timestamps, size_t size) {
+  return record([&] {
+    requireNonNull(matcher, "matcher");
+    requireArray(events, size, "events");
+    requireArray(timestamps, size, "timestamps");
+    if (matcher->isFinished) {
+      throw std::logic_error("the matcher is already finished");
+    }
+    matcher->monitor.feedBatch(std::span<const Alphabet>(events, size), std::span<const double>(timestamps, size));
+  }) ? 0 : -1;
+}
+
+int monaa_matcher_finish(monaa_matcher *matcher) {
+  return record([&] {
+    requireNonNull(matcher, "matcher");
+    if (!matcher->isFinished) {
+      matcher->isFinished = true;
+      matcher->monitor.finish();
+    }
+  }) ? 0 : -1;
+}
+
+size_t monaa_matcher_pending(const monaa_matcher *matcher) {
+  size_t size = 0;
+  record([&] {
+    requireNonNull(matcher, "matcher");
+    size = matcher->matches.size();
+  });
+  return size;
+}
+
+size_t monaa_matcher_drain(monaa_matcher *matcher, monaa_match *matches, size_t capacity) {
+  size_t size = 0;
+  record([&] {
+    requireNonNull(matcher, "matcher");
+    requireArray(matches, capacity, "matches");
+    size = std::min(capacity, matcher->matches.size());
+    std::copy_n(matcher->matches.begin(), size, matches);
+    matcher->matches.erase(matcher->matches.begin(), matcher->matches.begin() + size);
+  });
+  return size;
+}
+
+int monaa_match_batch(const monaa_pattern *pattern, const char *events, const double *timestamps, size_t size,
+                      monaa_match *matches, size_t capacity, size_t *found) {
+  return record([&] {
+    requireNonNull(pattern, "pattern");
+    requireArray(events, size, "events");
+    requireArray(timestamps, size, "timestamps");
+    requireArray(matches, capacity, "matches");
+    requireNonNull(found, "found");
+    AnsContainer<MatchBuffer> ans(MatchBuffer(matches, capacity));
+    batchMonaa(events, timestamps, size, *pattern->pattern, ans);
+    *found = ans.size();
+  }) ? 0 : -1;
+}
+}
@@ -0,0 +1,118 @@
+#ifndef MONAA_C_H
+#define MONAA_C_H
+
+/*!
+  @file monaa_c.h
+  @brief The C API of libmonaa
+
+  This is the stable interface of the shared library libmonaa for the callers in other languages. A pattern is compiled
+  once into an opaque handle, and a matcher created from it is fed with the events in the arrays owned by the caller.
+  The matches found so far are drained into an array owned by the caller, too. Each matcher is the same as @link
+  OnlineMonitor @endlink, and only the event mode is supported.
+
+  When all the events are in memory, monaa_match_batch() matches them in place without a matcher.
+
+  The functions returning a pointer return NULL on failure, and the functions returning an int return 0 on success and
+  -1 on failure. The reason of the last failure in the calling thread is given by monaa_last_error(). A NULL handle,
+  a NULL output, or a NULL array of a positive size is a failure, and the functions returning a size return 0 for it.
+  An empty pattern, i.e., a pattern accepting no timed word, is a failure of the compilation.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#define MONAA_API __declspec(dllexport)
+#else
+#define MONAA_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! @brief A compiled pattern
+typedef struct monaa_pattern monaa_pattern;
+
+//! @brief The state of an online matching with a pattern
+typedef struct monaa_matcher monaa_matcher;
+
+//! @brief An interval of real numbers. Each bound is inclusive if the corresponding flag is nonzero.
+typedef struct monaa_interval {
+  double lower;
+  double upper;
+  int lower_closed;
+  int upper_closed;
+} monaa_interval;
+
+/*!
+  @brief The set of the matching intervals [t, t') represented by one answer zone
+
+  The zone is the conjunction of the three constraints, i.e., t is in begin, t' is in end, and t' - t is in duration.
+ */
+typedef struct monaa_match {
+  monaa_interval begin;
+  monaa_interval end;
+  monaa_interval duration;
+} monaa_match;
+
+//! @brief Returns the reason of the last failure in the calling thread. The string is valid until the next failure.
+MONAA_API const char *monaa_last_error(void);
+
+//! @brief Compile a timed regular expression for the event mode
+MONAA_API monaa_pattern *monaa_pattern_compile_tre(const char *expression);
+
+//! @brief Compile a timed automaton in the DOT language for the event mode
+MONAA_API monaa_pattern *monaa_pattern_compile_dot(const char *dot);
+
+//! @brief Load a pattern compiled by monaa --compile. It must be for the event mode.
+MONAA_API monaa_pattern *monaa_pattern_load(const char *fileName);
+
+//! @brief Release a pattern. The matchers created from it remain valid.
+MONAA_API void monaa_pattern_free(monaa_pattern *pattern);
+
+//! @brief Create a matcher of a pattern. The matchers of a pattern share its skip values without copying them.
+MONAA_API monaa_matcher *monaa_matcher_new(const monaa_pattern *pattern);
+
+//! @brief Release a matcher including its undrained matches
+MONAA_API void monaa_matcher_free(monaa_matcher *matcher);
+
+/*!
+  @brief Feed a batch of events to a matcher
+
+  The i-th event is labelled with events[i] at timestamps[i]. The arrays are read only in this call, and only the
+  events that the matching may still need are kept in the matcher.
+ */
+MONAA_API int monaa_matcher_feed(monaa_matcher *matcher, const char *events, const double *timestamps, size_t size);
+
+//! @brief Notify the end of the events so that the matches ending after the last event are found
+MONAA_API int monaa_matcher_finish(monaa_matcher *matcher);
+
+//! @brief Returns the number of the matches found but not drained yet
+MONAA_API size_t monaa_matcher_pending(const monaa_matcher *matcher);
+
+/*!
+  @brief Move the matches found so far to an array, in the order they are found
+
+  @returns The number of the matches written to matches, which is at most capacity.
+ */
+MONAA_API size_t monaa_matcher_drain(monaa_matcher *matcher, monaa_match *matches, size_t capacity);
+
+/*!
+  @brief Match a pattern to the events in the arrays of the labels and the timestamps at once
+
+  The i-th event is labelled with events[i] at timestamps[i]. The events are not copied, and the matches are written to
+  the array owned by the caller.
+
+  @param [out] matches The array for the matches. Only the first capacity matches are written.
+  @param [in] capacity The number of the elements of matches.
+  @param [out] found The number of all the matches. If it is larger than capacity, the caller can retry with a larger
+  array.
+ */
+MONAA_API int monaa_match_batch(const monaa_pattern *pattern, const char *events, const double *timestamps,
+                                size_t size, monaa_match *matches, size_t capacity, size_t *found);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
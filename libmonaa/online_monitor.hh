@@ -0,0 +1,459 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "compiled_pattern.hh"
+#include "monaa.hh"
+#include "word_container.hh"
+
+/*!
+  @file online_monitor.hh
+  @brief Push-based online timed pattern matching
+ */
+
+/*!
+  @brief A monitor matching a pattern to the events pushed by the caller
+
+  This is the same algorithm as @link monaaDollar @endlink, but the caller pushes the events by feed() or feedBatch()
+  instead of the monitor pulling them from a @link WordContainer @endlink. When the monitor needs an event not pushed
+  yet, it keeps the position of the Sunday's shift or the configurations of the current matching, and it resumes from
+  there at the next push. Thus, the monitor does not block, and each answer zone is given to the callback as soon as the
+  event deciding it is pushed. The answer zones and their order are the same as @link monaaDollar @endlink.
+
+  The events and the configurations are stored in buffers reused during the monitoring. Once they are as large as the
+  events and the configurations in the longest matching, the monitor does not allocate memory.
+
+  @note The pattern must be compiled for the event mode.
+ */
+class OnlineMonitor {
+public:
+  using Event = std::pair<Alphabet, double>;
+  //! @brief The function called with the answer zone of each matching. The zone is overwritten after the call.
+  using Callback = std::function<void(const Zone &)>;
+
+  /*!
+    @param [in] pattern A pattern compiled for the event mode.
+    @param [in] callback The function called with the answer zone of each matching.
+    @throws std::invalid_argument if the pattern is not for the event mode
+   */
+  OnlineMonitor(CompiledPattern pattern, Callback callback)
+      : OnlineMonitor(std::make_shared<const CompiledPattern>(std::move(pattern)), std::move(callback)) {}
+
+  /*!
+    @brief Constructor sharing the compiled pattern with other monitors, e.g., the monitors of many keys
+
+    @param [in] pattern A pattern compiled for the event mode. It is not modified by the monitor.
+    @param [in] callback The function called with the answer zone of each matching.
+    @throws std::invalid_argument if the pattern is not for the event mode
+   */
+  OnlineMonitor(std::shared_ptr<const CompiledPattern> pattern, Callback callback)
+      : pattern(std::move(pattern)), callback(std::move(callback)) {
+    requireSupported(*this->pattern);
+  }
+
+  /*!
+    @brief Check if a pattern can be matched by OnlineMonitor
+
+    @throws std::invalid_argument if the pattern is not for the event mode or it has an epsilon transition
+   */
+  static void requireSupported(const CompiledPattern &pattern) {
+    if (pattern.mode != CompiledPattern::Mode::event) {
+      throw std::invalid_argument("OnlineMonitor: the pattern is not for the event mode");
+    }
+    if (std::any_of(pattern.automaton.states.begin(), pattern.automaton.states.end(),
+                    [](const std::shared_ptr<TAState> &s) { return s->next.find(0) != s->next.end(); })) {
+      throw std::invalid_argument("OnlineMonitor: the pattern has an epsilon transition");
+    }
+  }
+
+  //! @brief Push an event and match as far as possible
+  void feed(Alphabet c, double timestamp) {
+    word.push({c, timestamp});
+    run();
+  }
+
+  //! @brief Push events and match as far as possible
+  void feedBatch(std::span<const Event> events) {
+    for (const Event &event : events) {
+      word.push(event);
+    }
+    run();
+  }
+
+  /*!
+    @brief Push events given as the arrays of the labels and the timestamps, and match as far as possible
+
+    @pre events.size() == timestamps.size()
+   */
+  void feedBatch(std::span<const Alphabet> events, std::span<const double> timestamps) {
+    for (std::size_t n = 0; n < events.size(); ++n) {
+      word.push({events[n], timestamps[n]});
+    }
+    run();
+  }
+
+  /*!
+    @brief Notify the end of the timed word
+
+    The matchings ending after the last event are given to the callback. No event can be pushed after this.
+   */
+  void finish() {
+    isFinished = true;
+    run();
+  }
+
+  //! @brief Returns the number of the pushed events
+  std::size_t size() const { return word.size(); }
+
+  /*!
+    @brief Write the state of the monitoring as a binary snapshot
+
+    The snapshot starts with the magic "MONAACHK" and the version of the format, followed by the @link fingerprint
+    @endlink of the pattern, the starting position of the current matching (i.e., the position of the pending Sunday's
+    shift), the position of the next event, the events still needed by the matching, and the current configurations.
+    The events before the buffered window and the callback are not included.
+
+    @note The snapshot is in the native byte order and can be read only by @link restore @endlink of a monitor of the
+    same pattern on the same architecture. A pattern loaded by loadCompiledPattern() from the same file is the same
+    pattern, but a pattern compiled again may be numbered differently and is rejected.
+   */
+  void checkpoint(std::ostream &os) const {
+    std::unordered_map<const TAState *, std::uint64_t> toIndex;
+    for (std::size_t k = 0; k < pattern->automaton.stateSize(); ++k) {
+      toIndex[pattern->automaton.states[k].get()] = k;
+    }
+    os.write(magic, sizeof(magic));
+    write(os, version);
+    write<std::uint64_t>(os, fingerprint(*pattern));
+    write<std::uint8_t>(os, static_cast<std::uint8_t>(phase));
+    write<std::uint8_t>(os, isFinished);
+    write<std::uint64_t>(os, i);
+    write<std::uint64_t>(os, j);
+    // the buffered window
+    // The front can be after the last event when the Sunday's shift is pending.
+    const std::size_t front = word.getFront();
+    write<std::uint64_t>(os, front);
+    write<std::uint64_t>(os, word.size());
+    for (std::size_t n = front; n < word.size(); ++n) {
+      const Event event = word[n];
+      write(os, event.first);
+      write(os, event.second);
+    }
+    // The previous configurations are not needed because they are overwritten before the next use.
+    write<std::uint64_t>(os, CStates.size);
+    for (std::size_t k = 0; k < CStates.size; ++k) {
+      const IntervalInternalState &config = CStates.states[k];
+      write(os, toIndex.at(config.s));
+      for (const double t : config.resetTime) {
+        write(os, t);
+      }
+      write(os, config.upperConstraint.first);
+      write<std::uint8_t>(os, config.upperConstraint.second);
+      write(os, config.lowerConstraint.first);
+      write<std::uint8_t>(os, config.lowerConstraint.second);
+    }
+    if (!os) {
+      throw std::runtime_error("OnlineMonitor: failed to write the checkpoint");
+    }
+  }
+
+  /*!
+    @brief Restore the state of the monitoring from a snapshot written by @link checkpoint @endlink
+
+    The monitoring continues from the event after the last event pushed before the checkpoint. If the snapshot is
+    rejected, the monitor is not modified.
+
+    @throws std::runtime_error if the snapshot is broken, of another version, or its fingerprint is not the one of the
+    pattern
+   */
+  void restore(std::istream &is) {
+    char header[sizeof(magic)];
+    is.read(header, sizeof(header));
+    if (!is || !std::equal(header, header + sizeof(header), magic)) {
+      throw std::runtime_error("OnlineMonitor: not a checkpoint of MONAA");
+    }
+    if (read<std::uint32_t>(is) != version) {
+      throw std::runtime_error("OnlineMonitor: unsupported version of the checkpoint");
+    }
+    if (read<std::uint64_t>(is) != fingerprint(*pattern)) {
+      throw std::runtime_error("OnlineMonitor: the checkpoint is of another pattern");
+    }
+    const std::size_t clockSize = pattern->automaton.clockSize();
+    const auto newPhase = read<std::uint8_t>(is);
+    if (newPhase > static_cast<std::uint8_t>(Phase::done)) {
+      throw std::runtime_error("OnlineMonitor: broken checkpoint");
+    }
+    const bool newIsFinished = read<std::uint8_t>(is);
+    const auto newI = read<std::uint64_t>(is);
+    const auto newJ = read<std::uint64_t>(is);
+    // the buffered window
+    const auto front = read<std::uint64_t>(is);
+    const auto size = read<std::uint64_t>(is);
+    std::vector<Event> events;
+    for (std::uint64_t n = front; n < size; ++n) {
+      const auto c = read<Alphabet>(is);
+      events.emplace_back(c, read<double>(is));
+    }
+    Configurations newCStates;
+    for (auto configSize = read<std::uint64_t>(is); configSize > 0; --configSize) {
+      const auto stateIndex = read<std::uint64_t>(is);
+      if (stateIndex >= pattern->automaton.stateSize()) {
+        throw std::runtime_error("OnlineMonitor: broken checkpoint");
+      }
+      IntervalInternalState &config = newCStates.add(clockSize);
+      config.s = pattern->automaton.states[stateIndex].get();
+      for (double &t : config.resetTime) {
+        t = read<double>(is);
+      }
+      config.upperConstraint.first = read<double>(is);
+      config.upperConstraint.second = read<std::uint8_t>(is);
+      config.lowerConstraint.first = read<double>(is);
+      config.lowerConstraint.second = read<std::uint8_t>(is);
+    }
+    // The event before the starting position is in the buffered window. In the skip phase, the starting position can
+    // be after the last event, and the position of the next event is not used.
+    const bool isMatch = static_cast<Phase>(newPhase) == Phase::match;
+    if (front > (newI > 0 ? newI - 1 : 0) || (isMatch && (newJ < newI || newJ > size || newCStates.size == 0))) {
+      throw std::runtime_error("OnlineMonitor: broken checkpoint");
+    }
+
+    // We modify the monitor only after the whole snapshot is read and validated.
+    phase = static_cast<Phase>(newPhase);
+    isFinished = newIsFinished;
+    i = newI;
+    j = newJ;
+    word.reset(front, std::min(front, size));
+    for (const Event &event : events) {
+      word.push(event);
+    }
+    CStates = std::move(newCStates);
+    LastStates.size = 0;
+  }
+
+private:
+  enum class Phase {
+    //! @brief Shifting the starting position by the Sunday's skip value
+    skip,
+    //! @brief Matching from the starting position
+    match,
+    done
+  };
+
+  //! @brief The configurations of the matching stored in a reused buffer
+  struct Configurations {
+    std::vector<IntervalInternalState> states;
+    std::size_t size = 0;
+    //! @brief Append a configuration and returns it. The previous content of the returned configuration is garbage.
+    IntervalInternalState &add(std::size_t clockSize) {
+      if (size == states.size()) {
+        states.emplace_back(nullptr, std::vector<double>(clockSize, 0), Bounds{}, Bounds{});
+      }
+      return states[size++];
+    }
+  };
+
+  static constexpr char magic[8] = {'M', 'O', 'N', 'A', 'A', 'C', 'H', 'K'};
+  static constexpr std::uint32_t version = 1;
+
+  template <class T> static void write(std::ostream &os, const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <class T> static T read(std::istream &is) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    if (!is.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+      throw std::runtime_error("OnlineMonitor: truncated checkpoint");
+    }
+    return value;
+  }
+
+  std::shared_ptr<const CompiledPattern> pattern;
+  Callback callback;
+  WordEventBuffer<Event> word;
+  bool isFinished = false;
+  Phase phase = Phase::skip;
+  //! @brief The starting position of the current matching
+  std::size_t i = 0;
+  //! @brief The position of the next event in the current matching
+  std::size_t j = 0;
+  Configurations CStates;
+  Configurations LastStates;
+  Zone ansZone = Zone::zero(3);
+
+  //! @brief Give the matchings accepted by the transitions labelled with '$' before the j-th event to the callback
+  void acceptDollar(const Bounds &upperEndConstraint) {
+    const Bounds lowerEndConstraint = j > 0 ? Bounds{-word[j - 1].second, false} : Bounds{0, true};
+    for (std::size_t k = 0; k < CStates.size; ++k) {
+      const IntervalInternalState &config = CStates.states[k];
+      auto it = config.s->next.find('$');
+      if (it == config.s->next.end()) {
+        continue;
+      }
+      for (const auto &edge : it->second) {
+        if (edge.target && edge.target->isMatch &&
+            solveAcceptingTransition(config, edge, upperEndConstraint, lowerEndConstraint, ansZone)) {
+          callback(ansZone);
+        }
+      }
+    }
+  }
+
+  //! @brief Initialize the configurations at the i-th event
+  void start() {
+    CStates.size = 0;
+    LastStates.size = 0;
+    const Bounds upperConstraint = {word[i].second, false};
+    const Bounds lowerConstraint = i == 0 ? Bounds{0, true} : Bounds{-word[i - 1].second, true};
+    for (const auto &initialState : pattern->automaton.initialStates) {
+      IntervalInternalState &config = CStates.add(pattern->automaton.clockSize());
+      config.s = initialState.get();
+      std::fill(config.resetTime.begin(), config.resetTime.end(), 0);
+      config.upperConstraint = upperConstraint;
+      config.lowerConstraint = lowerConstraint;
+    }
+    j = i;
+  }
+
+  //! @brief Read the j-th event in the current matching
+  void step() {
+    const Alphabet c = word[j].first;
+    const double t = word[j].second;
+    // try to go to an accepting state unless the matchings are shorter than the minimum duration
+    if (t - (i > 0 ? word[i - 1].second : 0) >= pattern->duration.getMin()) {
+      acceptDollar({t, true});
+    }
+    // try observable transitions
+    std::swap(LastStates, CStates);
+    CStates.size = 0;
+    for (std::size_t k = 0; k < LastStates.size; ++k) {
+      const IntervalInternalState &config = LastStates.states[k];
+      auto it = config.s->next.find(c);
+      if (it == config.s->next.end()) {
+        continue;
+      }
+      for (const auto &edge : it->second) {
+        Bounds upperBeginConstraint, lowerBeginConstraint;
+        if (!edge.target || !solveTransition(config, edge, t, upperBeginConstraint, lowerBeginConstraint)) {
+          continue;
+        }
+        IntervalInternalState &next = CStates.add(pattern->automaton.clockSize());
+        next.s = edge.target;
+        next.resetTime = config.resetTime;
+        for (const ClockVariables x : edge.resetVars) {
+          next.resetTime[x] = t;
+        }
+        next.upperConstraint = upperBeginConstraint;
+        next.lowerConstraint = lowerBeginConstraint;
+      }
+    }
+    j++;
+  }
+
+  /*!
+    @brief Match as far as the pushed events allow
+
+    This follows the loop of @link monaaDollarLoop @endlink. When an event is not pushed yet, we return and resume
+    from the same phase at the next call. The only difference is when a matching dies at the end of the timed word:
+    we use the last configurations for the KMP-type skip value instead of skipping by one, which is also safe.
+   */
+  void run() {
+    const SundaySkipValue &delta = pattern->delta;
+    const int m = delta.getM();
+    // Returns true if the n-th event is pushed. Otherwise, we stop if it is the end of the timed word.
+    const auto fetch = [&](std::size_t n) {
+      if (word.fetch(n)) {
+        return true;
+      }
+      if (isFinished) {
+        phase = Phase::done;
+      }
+      return false;
+    };
+
+    while (phase != Phase::done) {
+      if (phase == Phase::skip) {
+        if (!fetch(i + m - 1)) {
+          return;
+        }
+        if (m > 1) {
+          // Sunday Shift
+          bool isPending = false;
+          while (!delta.isEndChar(word[i + m - 1].first)) {
+            if (!fetch(i + m)) {
+              isPending = true;
+              break;
+            }
+            // We wait for the next event for the q-gram unless it is the end.
+            if (delta.useQGram() && !word.fetch(i + m + 1) && !isFinished) {
+              isPending = true;
+              break;
+            }
+            if (delta.useQGram() && word.fetch(i + m + 1)) {
+              i += delta(word[i + m].first, word[i + m + 1].first);
+            } else {
+              i += delta[word[i + m].first];
+            }
+            word.setFront(i - 1);
+            if (!fetch(i + m - 1)) {
+              isPending = true;
+              break;
+            }
+          }
+          if (isPending) {
+            return;
+          }
+          // Skip the positions from which the first m events are longer than the maximum duration
+          const std::size_t nextI = pattern->duration.nextStart(word, i, i + m - 1);
+          if (nextI > i) {
+            i = nextI;
+            word.setFront(i - 1);
+            continue;
+          }
+        }
+        start();
+        phase = Phase::match;
+      }
+
+      // KMP like Matching
+      while (CStates.size > 0) {
+        if (!word.fetch(j)) {
+          if (!isFinished) {
+            return;
+          }
+          // try to go to an accepting state after the last event
+          acceptDollar({std::numeric_limits<double>::infinity(), true});
+          std::swap(LastStates, CStates);
+          CStates.size = 0;
+          break;
+        }
+        // The matchings reaching here are longer than the maximum duration
+        if (j > i && word[j - 1].second - word[i].second > pattern->duration.getMax()) {
+          break;
+        }
+        step();
+      }
+      // KMP like skip value
+      int greatestN = 1;
+      for (std::size_t k = 0; k < LastStates.size; ++k) {
+        greatestN = std::max(pattern->beta[LastStates.states[k].s], greatestN);
+      }
+      i += greatestN;
+      word.setFront(i - 1);
+      phase = Phase::skip;
+    }
+  }
+};
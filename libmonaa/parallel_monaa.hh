@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ans_vec.hh"
+#include "compiled_pattern.hh"
+#include "match_stats.hh"
+#include "monaa.hh"
+#include "word_container.hh"
+
+/*!
+  @file parallel_monaa.hh
+  @brief Timed pattern matching of a timed word in memory with multiple threads
+ */
+
+/*!
+  @brief The labels in each block of a timed word, collected in one scan shared by all the patterns.
+
+  A matching of a pattern with m > 1 starting from the i-th position has an end character of Sunday's skip value at
+  the (i + m - 1)-th position. Therefore, the starting positions of the matchings of a pattern are only before the
+  blocks containing one of its end characters, and the other positions need not be matched at all.
+ */
+class EndCharBlocks {
+public:
+  //! @brief The number of the events in a block
+  static constexpr std::size_t blockSize = 4096;
+
+  explicit EndCharBlocks(const std::vector<std::pair<Alphabet, double>> &word)
+      : size(word.size()), labels((word.size() + blockSize - 1) / blockSize) {
+    for (std::size_t n = 0; n < word.size(); ++n) {
+      const auto u = static_cast<unsigned char>(word[n].first);
+      labels[n / blockSize][u >> 6] |= std::uint64_t(1) << (u & 63);
+    }
+  }
+
+  /*!
+    @brief Returns the ranges [begin, end) of the starting positions of the possible matchings of a pattern
+
+    The ranges are sorted and disjoint. If the maximum duration of the pattern is unbounded, the matching of a range
+    reads the rest of the timed word, and we return only one range covering all the possible starting positions.
+   */
+  std::vector<std::pair<std::size_t, std::size_t>> startRanges(const CompiledPattern &pattern) const {
+    const std::size_t m = pattern.delta.getM();
+    if (m <= 1) {
+      return {{0, size}};
+    }
+    const auto &endCharMask = pattern.delta.getEndCharMask();
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    for (std::size_t b = 0; b < labels.size(); ++b) {
+      const std::size_t blockBegin = b * blockSize;
+      const std::size_t blockEnd = std::min(size, blockBegin + blockSize);
+      const bool hasEndChar = (labels[b][0] & endCharMask[0]) || (labels[b][1] & endCharMask[1]) ||
+                              (labels[b][2] & endCharMask[2]) || (labels[b][3] & endCharMask[3]);
+      if (!hasEndChar || blockEnd < m) {
+        continue;
+      }
+      // The starting positions whose (m - 1)-th next event is in this block
+      const std::size_t begin = blockBegin < m - 1 ? 0 : blockBegin - (m - 1);
+      const std::size_t end = blockEnd - (m - 1);
+      if (!ranges.empty() && ranges.back().second >= begin) {
+        ranges.back().second = end;
+      } else {
+        ranges.emplace_back(begin, end);
+      }
+    }
+    if (std::isinf(pattern.duration.getMax()) && ranges.size() > 1) {
+      ranges = {{ranges.front().first, ranges.back().second}};
+    }
+    return ranges;
+  }
+
+private:
+  std::size_t size;
+  //! @brief The 256-bit membership mask of the labels in each block
+  std::vector<std::array<std::uint64_t, 4>> labels;
+};
+
+/*!
+  @brief Match the chunks of a timed word with the given patterns in parallel.
+
+  The starting positions of the matchings are split into chunks, and each chunk is matched by @link monaaDollar
+  @endlink (or @link monaa @endlink in the signal mode) in a thread. Since no matching is longer than the maximum
+  duration of the pattern, the matchings starting in a chunk are found in the events of the chunk followed by the
+  events within the maximum duration, which are shared with the next chunk. A matching starting from the i-th
+  position satisfies word[i - 1].second <= t < word[i].second, and we keep only the matchings whose lower bound of t
+  is in the chunk. If the maximum duration of a pattern is unbounded, the whole word is one chunk.
+
+  The timed word is scanned once for the labels of its blocks (see EndCharBlocks), and the chunks of each pattern are
+  cut down to the starting positions before the blocks with its end characters. A pattern whose end characters do
+  not appear in the timed word is not matched at all.
+
+  @param [out] counters The counters of the matching loops. Each chunk is counted separately and they are merged
+  after the matching. The events are the ones in the timed word. If it is nullptr, they are not reported.
+  @returns The answer zones of each chunk of each pattern. Their concatenation for a pattern is the same as the result
+  of the sequential matching, including the order.
+ */
+inline std::vector<std::vector<AnsVec<Zone>>>
+matchChunks(const std::vector<std::pair<Alphabet, double>> &word, const std::vector<const CompiledPattern *> &patterns,
+            std::size_t threadSize, MatchCounters *counters = nullptr) {
+  using Event = std::pair<Alphabet, double>;
+  if (threadSize == 0) {
+    threadSize = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  const EndCharBlocks blocks(word);
+  std::vector<std::vector<AnsVec<Zone>>> answers(patterns.size());
+  // The index of a pattern and the starting positions [begin, end) of a chunk
+  struct Task {
+    std::size_t p;
+    std::size_t begin;
+    std::size_t end;
+    AnsVec<Zone> *ans;
+    //! @brief The counters of this chunk, which are not shared with the other threads
+    MatchCounters counters;
+  };
+  std::vector<Task> tasks;
+  for (std::size_t p = 0; p < patterns.size(); ++p) {
+    const bool isBounded = !std::isinf(patterns[p]->duration.getMax());
+    // We make more chunks than the threads so that a thread with a chunk of few events takes another chunk.
+    const std::size_t chunkSize =
+        (threadSize > 1 && isBounded) ? std::max<std::size_t>(1, std::min(word.size(), threadSize * 4)) : 1;
+    const auto ranges = blocks.startRanges(*patterns[p]);
+    const std::size_t firstTask = tasks.size();
+    for (std::size_t k = 0; k < chunkSize; ++k) {
+      const std::size_t chunkBegin = word.size() * k / chunkSize;
+      const std::size_t chunkEnd = word.size() * (k + 1) / chunkSize;
+      for (const auto &range : ranges) {
+        const std::size_t begin = std::max(chunkBegin, range.first);
+        const std::size_t end = std::min(chunkEnd, range.second);
+        if (begin < end) {
+          tasks.push_back({p, begin, end, nullptr, {}});
+        }
+      }
+    }
+    answers[p].resize(tasks.size() - firstTask);
+    for (std::size_t k = firstTask; k < tasks.size(); ++k) {
+      tasks[k].ans = &answers[p][k - firstTask];
+    }
+  }
+
+  const auto matchChunk = [&](Task &task) {
+    const CompiledPattern &pattern = *patterns[task.p];
+    // The starting positions in this chunk
+    const std::size_t begin = task.begin;
+    const std::size_t end = task.end;
+    // We also give the (begin - 1)-th event for the lower bound of t. The matchings starting from it are removed.
+    const std::size_t sliceBegin = begin == 0 ? 0 : begin - 1;
+    std::size_t sliceEnd = word.size();
+    if (end < word.size()) {
+      // The matchings starting in this chunk end by word[end - 1].second + maxDuration, and we need the first event
+      // after it to accept them.
+      const double limit = word[end - 1].second + pattern.duration.getMax();
+      const auto it = std::lower_bound(word.begin() + end, word.end(), limit,
+                                       [](const Event &event, double t) { return event.second < t; });
+      sliceEnd = std::min<std::size_t>(word.size(), it - word.begin() + 1);
+    }
+    const double lowerT = begin == 0 ? -std::numeric_limits<double>::infinity() : word[begin - 1].second;
+    const double upperT = end == word.size() ? std::numeric_limits<double>::infinity() : word[end - 1].second;
+
+    AnsVec<Zone> sliceAns;
+    WordSlice<Event> slice(word.data() + sliceBegin, sliceEnd - sliceBegin);
+    MatchCounters *taskCounters = counters ? &task.counters : nullptr;
+    if (pattern.mode == CompiledPattern::Mode::signal) {
+      monaa(std::move(slice), pattern, sliceAns, taskCounters);
+    } else {
+      monaaDollar(std::move(slice), pattern, sliceAns, taskCounters);
+    }
+    if (begin == 0 && end == word.size()) {
+      *task.ans = std::move(sliceAns);
+      return;
+    }
+    for (const Zone &zone : sliceAns) {
+      const double t = -zone.value(0, 1).first;
+      if (lowerT <= t && t < upperT) {
+        task.ans->push_back(zone);
+      }
+    }
+  };
+
+  std::atomic<std::size_t> nextTask{0};
+  const auto runTasks = [&] {
+    for (std::size_t i = nextTask++; i < tasks.size(); i = nextTask++) {
+      matchChunk(tasks[i]);
+    }
+  };
+  if (threadSize == 1 || tasks.size() <= 1) {
+    runTasks();
+  } else {
+    std::vector<std::thread> threads;
+    threads.reserve(threadSize);
+    for (std::size_t k = 0; k < std::min(threadSize, tasks.size()); ++k) {
+      threads.emplace_back(runTasks);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  if (counters) {
+    for (const Task &task : tasks) {
+      counters->merge(task.counters);
+    }
+    counters->events = word.size();
+  }
+  return answers;
+}
+
+/*!
+  @brief Execute the timed FJS algorithm on the chunks of a timed word in parallel.
+
+  See matchChunks() for the splitting of the timed word. The result is the same as the sequential matching, including
+  the order.
+
+  @note If the maximum duration of the pattern is unbounded, the timed word is matched in one thread.
+
+  @param [in] word The timed word representing a log.
+  @param [in] pattern A pattern compiled in advance.
+  @param [out] ans A container for the answer zone.
+  @param [in] threadSize The number of the threads. If it is 0, we use the number of the hardware threads.
+  @param [out] counters The counters of the matching loops merged over the chunks. If it is nullptr, they are not
+  reported.
+*/
+template <class OutputContainer>
+void parallelMonaa(const std::vector<std::pair<Alphabet, double>> &word, const CompiledPattern &pattern,
+                   AnsContainer<OutputContainer> &ans, std::size_t threadSize, MatchCounters *counters = nullptr) {
+  ans.clear();
+  auto answers = matchChunks(word, {&pattern}, threadSize, counters);
+  for (auto &chunkAns : answers.front()) {
+    for (const Zone &zone : chunkAns) {
+      ans.push_back(zone);
+    }
+  }
+}
+
+/*!
+  @brief Execute the timed FJS algorithm with many patterns over one timed word.
+
+  The timed word is read and parsed only once and shared by the patterns. It is scanned once for the end characters
+  of all the patterns, and each pattern is matched only before the blocks with its end characters (see
+  EndCharBlocks), with its own skip values and its own configurations. The chunks of all the patterns are matched in
+  parallel by threadSize threads.
+
+  @note The blocks with the end characters of several patterns are still matched once for each of them. See
+  @link monaaMerged @endlink for the matching of all the patterns in one pass.
+
+  @param [in] word The timed word representing a log.
+  @param [in] patterns The patterns compiled in advance.
+  @param [out] ans The containers for the answer zones, e.g., AnsVec or AnsPrinter. ans[k] is for patterns[k].
+  @param [in] threadSize The number of the threads. If it is 0, we use the number of the hardware threads.
+  @param [out] counters The counters of the matching loops merged over the chunks of all the patterns. If it is
+  nullptr, they are not reported.
+  @pre ans.size() == patterns.size()
+*/
+template <class Answer>
+void multiMonaa(const std::vector<std::pair<Alphabet, double>> &word,
+                const std::vector<const CompiledPattern *> &patterns, std::vector<Answer> &ans,
+                std::size_t threadSize, MatchCounters *counters = nullptr) {
+  auto answers = matchChunks(word, patterns, threadSize, counters);
+  for (std::size_t p = 0; p < patterns.size(); ++p) {
+    ans[p].clear();
+    for (auto &chunkAns : answers[p]) {
+      for (const Zone &zone : chunkAns) {
+        ans[p].push_back(zone);
+      }
+    }
+  }
+}
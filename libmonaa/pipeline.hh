@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ans_vec.hh"
+#include "lazy_deque.hh"
+#include "spsc_ring_buffer.hh"
+#include "word_container.hh"
+
+/*!
+  @file pipeline.hh
+  @brief Online timed pattern matching in a pipeline of a reader, a matcher, and a writer
+ */
+
+//! @brief The ring buffer of the events from the reader to the matcher
+using EventRingBuffer = SPSCRingBuffer<std::pair<Alphabet, double>>;
+
+//! @brief The ring buffer of the answer zones from the matcher to the writer, with the index of the pattern
+using AnsRingBuffer = SPSCRingBuffer<std::pair<std::size_t, Zone>>;
+
+/*!
+  @brief A deque of the events popped from a ring buffer. This class is given to @link WordContainer @endlink class as
+  its template argument.
+
+  This is the same as @link LazyDeque @endlink except that the events are parsed by another thread.
+ */
+class RingDeque : public std::deque<std::pair<Alphabet, double>> {
+private:
+  std::size_t front = 0;
+  std::size_t N = std::numeric_limits<std::size_t>::max();
+  EventRingBuffer *ring = nullptr;
+
+public:
+  RingDeque(FILE *, bool) {}
+  void assign(EventRingBuffer *newRing) { ring = newRing; }
+  std::pair<Alphabet, double> operator[](std::size_t n) {
+    const std::size_t indInDeque = n - front;
+    if (n < front || n >= N || indInDeque >= std::deque<std::pair<Alphabet, double>>::size()) {
+      throw std::out_of_range("thrown at RingDeque::operator[] ");
+    }
+    return std::deque<std::pair<Alphabet, double>>::operator[](indInDeque);
+  }
+  std::pair<Alphabet, double> at(std::size_t n) { return (*this)[n]; }
+  std::size_t size() const { return N; }
+  //! @brief Update the internal front. The elements before the front are removed.
+  void setFront(std::size_t newFront) {
+    if (newFront < front) {
+      throw std::out_of_range("thrown at RingDeque::setFront ");
+    }
+    const std::size_t eraseSize = std::min(newFront - front, std::deque<std::pair<Alphabet, double>>::size());
+    std::size_t popTimes = (newFront - front) - eraseSize;
+    front = newFront;
+    this->erase(this->begin(), this->begin() + eraseSize);
+    std::pair<Alphabet, double> elem;
+    while (popTimes-- > 0 && ring->pop(elem)) {
+    }
+  }
+  bool fetch(std::size_t n) {
+    if (n < front || n >= N) {
+      return false;
+    }
+    while (n - front >= std::deque<std::pair<Alphabet, double>>::size()) {
+      std::pair<Alphabet, double> elem;
+      if (!ring->pop(elem)) {
+        N = front + std::deque<std::pair<Alphabet, double>>::size();
+        return false;
+      }
+      this->push_back(elem);
+    }
+    return true;
+  }
+};
+
+/*!
+  @class WordRingDeque
+  @brief Word container of the events pushed to a ring buffer by another thread.
+*/
+class WordRingDeque : public WordContainer<RingDeque> {
+public:
+  explicit WordRingDeque(EventRingBuffer &ring) : WordContainer<RingDeque>(nullptr, false) { this->vec.assign(&ring); }
+};
+
+/*!
+  @brief A pseudo-container class to pass the given zone to the writer thread. This is given to @link AnsContainer
+  @endlink.
+ */
+class RingContainer {
+private:
+  std::size_t count = 0;
+  AnsRingBuffer *ring;
+  std::size_t patternID;
+
+public:
+  /*!
+    @param [in] ring The ring buffer to the writer thread.
+    @param [in] patternID The index of the pattern sent with the zones.
+   */
+  RingContainer(AnsRingBuffer &ring, std::size_t patternID = 0) : ring(&ring), patternID(patternID) {}
+  //! @brief Returns the count of output zones.
+  std::size_t size() const { return count; }
+  void push_back(const Zone &ans) {
+    count++;
+    ring->push({patternID, ans});
+  }
+  //! @brief Resets the count of output zones.
+  void clear() { count = 0; }
+  //! @brief Does nothing.
+  void reserve(std::size_t) {}
+  using value_type = Zone;
+};
+
+using AnsRing = AnsContainer<RingContainer>;
+
+/*!
+  @brief Execute an online matching in a pipeline of three threads.
+
+  A reader thread parses the timed word in file and pushes the events to a ring buffer. The calling thread runs
+  match(word, ans), where word is a @link WordRingDeque @endlink popping the events, and ans[k] is an @link AnsRing
+  @endlink for the k-th pattern. A writer thread pops the answer zones and pushes them to printers[k]. The result is the
+  same as the matching in one thread, including the order.
+
+  @param [in] file The FILE-pointer of the file in which the input timed word is.
+  @param [in] isBinary A flag if the input is in a binary file.
+  @param [out] printers The containers for the answer zones of each pattern, e.g., AnsPrinter.
+  @param [in] match The matching, e.g., a call of @link monaaDollar @endlink with ans[0].
+  @param [in] capacity The capacity of each ring buffer.
+
+  @note If the matching throws or returns before the end of the input, the reader thread may be blocked in reading a
+  live input, e.g., stdin, which cannot be interrupted. Then, we detach the reader instead of waiting for the next
+  event. It exits at the next event or the end of the input because the ring buffer is closed, so the caller must not
+  close file while the process continues.
+ */
+template <class Answer, class Match>
+void pipelineMonaa(FILE *file, bool isBinary, std::vector<Answer> &printers, Match &&match,
+                   std::size_t capacity = 1 << 12) {
+  assert(file != nullptr);
+  // The state shared with the reader, which may outlive this function if it is detached
+  struct Input {
+    explicit Input(std::size_t capacity) : events(capacity) {}
+    EventRingBuffer events;
+    //! @brief If the reader does not read the file any more
+    std::atomic<bool> isDone{false};
+  };
+  const auto input = std::make_shared<Input>(capacity);
+  EventRingBuffer &events = input->events;
+  AnsRingBuffer zones(capacity);
+
+  std::thread reader([input, file, isBinary] {
+    const auto getElem = isBinary ? getOneBinary : getOne;
+    std::pair<Alphabet, double> elem;
+    while (getElem(file, elem) != EOF && input->events.push(elem)) {
+    }
+    input->isDone = true;
+    input->events.close();
+  });
+  std::thread writer([&] {
+    std::pair<std::size_t, Zone> zone;
+    while (zones.pop(zone)) {
+      printers[zone.first].push_back(zone.second);
+    }
+  });
+
+  std::vector<AnsRing> ans;
+  ans.reserve(printers.size());
+  for (std::size_t k = 0; k < printers.size(); ++k) {
+    printers[k].clear();
+    ans.emplace_back(RingContainer(zones, k));
+  }
+  std::exception_ptr error;
+  try {
+    match(WordRingDeque(events), ans);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // We close the events too so that the reader stops when the matching fails.
+  events.close();
+  zones.close();
+  if (input->isDone) {
+    reader.join();
+  } else {
+    reader.detach();
+  }
+  writer.join();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
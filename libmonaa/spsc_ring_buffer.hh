@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*!
+  @brief A bounded single-producer single-consumer queue
+
+  One thread pushes the values and another thread pops them. Each side owns one of the indices, and it reads the other
+  index only when its cached copy says the buffer is full (or empty). Thus, while both threads keep up with each other,
+  a value is transferred without any lock. A thread that cannot proceed yields for a while and then sleeps on a
+  condition variable, which is notified only when the other thread sees that it is sleeping.
+
+  Either side can close the buffer. After that, push() fails, and pop() fails once the pushed values are popped.
+ */
+template <class T> class SPSCRingBuffer {
+public:
+  /*!
+    @param [in] capacity The maximum number of the values in the buffer. It is rounded up to a power of two.
+   */
+  explicit SPSCRingBuffer(std::size_t capacity) : buffer(roundUp(capacity)), mask(buffer.size() - 1) {}
+
+  /*!
+    @brief Push a value. If the buffer is full, we wait until the consumer pops a value.
+
+    @returns false if the buffer is closed
+   */
+  bool push(T value) {
+    const std::size_t t = tail.load(std::memory_order_relaxed);
+    if (t - cachedHead == buffer.size()) {
+      wait(producerWaiting, [&] { return t - head.load() < buffer.size() || closed.load(); });
+      cachedHead = head.load(std::memory_order_acquire);
+    }
+    if (closed.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    buffer[t & mask] = std::move(value);
+    tail.store(t + 1);
+    wake(consumerWaiting);
+    return true;
+  }
+
+  /*!
+    @brief Pop a value. If the buffer is empty, we wait until the producer pushes a value.
+
+    @returns false if the buffer is closed and empty
+   */
+  bool pop(T &value) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    if (h == cachedTail) {
+      wait(consumerWaiting, [&] { return tail.load() != h || closed.load(); });
+      cachedTail = tail.load(std::memory_order_acquire);
+      if (h == cachedTail) {
+        return false;
+      }
+    }
+    value = std::move(buffer[h & mask]);
+    head.store(h + 1);
+    wake(producerWaiting);
+    return true;
+  }
+
+  //! @brief Close the buffer and wake the waiting thread
+  void close() {
+    closed.store(true);
+    wake(producerWaiting);
+    wake(consumerWaiting);
+  }
+
+private:
+  static std::size_t roundUp(std::size_t capacity) {
+    std::size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  //! @brief The number of the times to yield before sleeping
+  static constexpr int spinCount = 64;
+
+  template <class Predicate> void wait(std::atomic<bool> &waiting, Predicate ready) {
+    for (int k = 0; k < spinCount; ++k) {
+      if (ready()) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    // Since both the flag and the index are sequentially consistent, either the other thread sees the flag after
+    // updating the index, or ready() sees the updated index.
+    waiting.store(true);
+    condition.wait(lock, ready);
+    waiting.store(false);
+  }
+
+  void wake(std::atomic<bool> &waiting) {
+    if (waiting.load()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      condition.notify_all();
+    }
+  }
+
+  std::vector<T> buffer;
+  const std::size_t mask;
+  //! @brief The index of the next value to pop. It is written only by the consumer.
+  alignas(64) std::atomic<std::size_t> head{0};
+  //! @brief The copy of tail seen by the consumer
+  std::size_t cachedTail = 0;
+  //! @brief The index of the next value to push. It is written only by the producer.
+  alignas(64) std::atomic<std::size_t> tail{0};
+  //! @brief The copy of head seen by the producer
+  std::size_t cachedHead = 0;
+  alignas(64) std::atomic<bool> closed{false};
+  std::atomic<bool> producerWaiting{false};
+  std::atomic<bool> consumerWaiting{false};
+  std::mutex mutex;
+  std::condition_variable condition;
+};
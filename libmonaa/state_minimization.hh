@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "timed_automaton.hh"
+
+/*!
+  @brief The numbers of the states before and after the state minimization
+ */
+struct StateMinimization {
+  std::size_t before;
+  std::size_t after;
+};
+
+/*!
+  @brief Merge the bisimilar states by partition refinement
+
+  Initially, the states are partitioned by the acceptance and the zero duration flag. Then, we repeatedly split each
+  class by the signature of its states, i.e., the set of the outgoing (label, guard, reset, target class) tuples, until
+  the partition becomes stable. Since the states in a class have the same transitions up to the classes of the targets,
+  they accept the same timed words from the same clock valuation, and we merge them to the first one in TA.states.
+
+  @note The transitions of TA are modified in place. Make a deep copy if the states are shared with another automaton.
+  @returns The numbers of the states before and after the minimization
+ */
+inline StateMinimization minimizeStates(TimedAutomaton &TA) {
+  const std::size_t before = TA.stateSize();
+  std::unordered_map<const TAState *, std::size_t> toIndex;
+  toIndex.reserve(before);
+  for (std::size_t i = 0; i < before; ++i) {
+    toIndex[TA.states[i].get()] = i;
+  }
+  // The target of each transition is represented by the index of the state. The null target is represented by before.
+  using Guard = std::vector<std::tuple<ClockVariables, Constraint::Order, int>>;
+  using Edge = std::tuple<Alphabet, Guard, std::vector<ClockVariables>, std::size_t>;
+  std::vector<std::vector<Edge>> edges(before);
+  for (std::size_t i = 0; i < before; ++i) {
+    for (const auto &transitions : TA.states[i]->next) {
+      for (const auto &transition : transitions.second) {
+        Guard guard;
+        guard.reserve(transition.guard.size());
+        for (const auto &constraint : transition.guard) {
+          guard.emplace_back(constraint.x, constraint.odr, constraint.c);
+        }
+        std::sort(guard.begin(), guard.end());
+        guard.erase(std::unique(guard.begin(), guard.end()), guard.end());
+        std::vector<ClockVariables> resetVars = transition.resetVars;
+        std::sort(resetVars.begin(), resetVars.end());
+        resetVars.erase(std::unique(resetVars.begin(), resetVars.end()), resetVars.end());
+        edges[i].emplace_back(transitions.first, std::move(guard), std::move(resetVars),
+                              transition.target ? toIndex.at(transition.target) : before);
+      }
+    }
+  }
+
+  // The class of each state
+  std::vector<std::size_t> classOf(before);
+  std::size_t classSize = 0;
+  {
+    std::map<std::pair<bool, bool>, std::size_t> toClass;
+    for (std::size_t i = 0; i < before; ++i) {
+      const auto key = std::make_pair(TA.states[i]->isMatch, TA.states[i]->zeroDuration);
+      classOf[i] = toClass.emplace(key, toClass.size()).first->second;
+    }
+    classSize = toClass.size();
+  }
+  for (;;) {
+    using Signature = std::pair<std::size_t, std::vector<Edge>>;
+    std::map<Signature, std::size_t> toClass;
+    std::vector<std::size_t> nextClassOf(before);
+    for (std::size_t i = 0; i < before; ++i) {
+      Signature signature{classOf[i], edges[i]};
+      for (auto &edge : signature.second) {
+        auto &target = std::get<3>(edge);
+        target = target == before ? before : classOf[target];
+      }
+      std::sort(signature.second.begin(), signature.second.end());
+      signature.second.erase(std::unique(signature.second.begin(), signature.second.end()), signature.second.end());
+      nextClassOf[i] = toClass.emplace(std::move(signature), toClass.size()).first->second;
+    }
+    classOf = std::move(nextClassOf);
+    // Since the partition is only refined, it is stable if the number of the classes does not change.
+    if (toClass.size() == classSize) {
+      break;
+    }
+    classSize = toClass.size();
+  }
+  if (classSize == before) {
+    return {before, before};
+  }
+
+  // The representative of each class
+  std::vector<TAState *> representative(classSize, nullptr);
+  for (std::size_t i = 0; i < before; ++i) {
+    if (!representative[classOf[i]]) {
+      representative[classOf[i]] = TA.states[i].get();
+    }
+  }
+  const auto toRepresentative = [&](const TAState *s) {
+    return representative[classOf[toIndex.at(s)]];
+  };
+  for (std::size_t i = 0; i < before; ++i) {
+    TAState *state = TA.states[i].get();
+    if (representative[classOf[i]] != state) {
+      continue;
+    }
+    for (auto &transitions : state->next) {
+      std::vector<TATransition> newTransitions;
+      newTransitions.reserve(transitions.second.size());
+      for (auto &transition : transitions.second) {
+        if (transition.target) {
+          transition.target = toRepresentative(transition.target);
+        }
+        const bool isDuplicated =
+            std::any_of(newTransitions.begin(), newTransitions.end(), [&](const TATransition &added) {
+              return added.target == transition.target && added.resetVars == transition.resetVars &&
+                     std::equal(added.guard.begin(), added.guard.end(), transition.guard.begin(),
+                                transition.guard.end(), [](const Constraint &left, const Constraint &right) {
+                                  return left.x == right.x && left.odr == right.odr && left.c == right.c;
+                                });
+            });
+        if (!isDuplicated) {
+          newTransitions.push_back(std::move(transition));
+        }
+      }
+      transitions.second = std::move(newTransitions);
+    }
+  }
+
+  std::vector<std::shared_ptr<TAState>> initialStates;
+  initialStates.reserve(TA.initialStates.size());
+  for (const auto &s : TA.initialStates) {
+    TAState *r = toRepresentative(s.get());
+    if (std::none_of(initialStates.begin(), initialStates.end(),
+                     [r](const std::shared_ptr<TAState> &added) { return added.get() == r; })) {
+      initialStates.push_back(TA.states[toIndex.at(r)]);
+    }
+  }
+  TA.initialStates = std::move(initialStates);
+  std::vector<std::shared_ptr<TAState>> states;
+  states.reserve(classSize);
+  for (std::size_t i = 0; i < before; ++i) {
+    if (representative[classOf[i]] == TA.states[i].get()) {
+      states.push_back(std::move(TA.states[i]));
+    }
+  }
+  TA.states = std::move(states);
+
+  return {before, TA.stateSize()};
+}
@@ -1,16 +1,38 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <chrono>
 #include <climits>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #include "ta2za.hh"
 #include "timed_automaton.hh"
 #include "zone_automaton.hh"
 
+//! @brief The exception thrown when a pattern accepts no timed word
+class EmptyPatternError : public std::runtime_error {
+public:
+  EmptyPatternError() : std::runtime_error("empty pattern") {}
+};
+
 /*!
  * @brief The skip value function based on Sunday's quick search
  *
+ * In addition to the usual table indexed by the character just after the window, we construct the table indexed by
+ * the two characters after the window (q-gram with q = 2) from the untimed language. For small alphabets, the former is
+ * almost always 1 while the latter can be larger, and we use the one with the larger average shift.
+ *
  * @note We construct the table maintaining all the skip values in the constructor for the efficiency at runtime.
  * @sa https://doi.org/10.1145/79173.79184
  */
@@ -18,42 +40,122 @@ class SundaySkipValue {
 private:
   //! @brief Minimum length of the recognized language
   int m;
-  std::array<unsigned int, CHAR_MAX> delta{};
-  //! @brief The set of the m-th characters of the untimed projection of the recognized language
-  std::unordered_set<char> endChars;
+  //! @brief The skip value indexed by the character as an unsigned byte
+  std::array<unsigned int, UCHAR_MAX + 1> delta{};
+  /*!
+   * @brief The set of the m-th characters of the untimed projection of the recognized language
+   *
+   * @note This is a 256-bit membership mask indexed by the character as an unsigned byte.
+   */
+  std::array<std::uint64_t, 4> endCharMask{};
+  /*!
+   * @brief The end character mask rearranged for the nibble lookup of findEndChar
+   *
+   * The k-th bit of endCharNibbles[lo] (resp. endCharNibbles[16 + lo]) is set if the character (k << 4 | lo) (resp.
+   * ((k + 8) << 4 | lo)) is an end character.
+   */
+  std::array<std::uint8_t, 32> endCharNibbles{};
+
+  /*!
+   * @brief The skip value for the two characters after the window. This is used only if isQGram is true.
+   *
+   * @note This is indexed by the pair of the characters as unsigned bytes, i.e., by qGramIndex().
+   */
+  std::vector<unsigned int> qGramDelta;
+  //! @brief If the q-gram skip value gives a larger average shift than the single-character one.
+  bool isQGram;
+  //! @brief The average shift of the selected table
+  double expectedShift;
+  std::chrono::nanoseconds constructionTime{0};
+  std::chrono::nanoseconds ta2zaTime{0};
+
+  //! @brief The index of a byte in delta. Any byte, including the ones not in the pattern, is in range.
+  static std::size_t index(Alphabet c) { return static_cast<unsigned char>(c); }
+  static std::size_t qGramIndex(Alphabet a, Alphabet b) { return index(a) * (UCHAR_MAX + 1) + index(b); }
+
+  void addEndChar(Alphabet c) {
+    const auto u = static_cast<unsigned char>(c);
+    endCharMask[u >> 6] |= std::uint64_t(1) << (u & 63);
+  }
+  void makeEndCharNibbles() {
+    endCharNibbles.fill(0);
+    for (int u = 0; u <= UCHAR_MAX; u++) {
+      if (isEndChar(static_cast<Alphabet>(u))) {
+        endCharNibbles[(u >> 7) * 16 + (u & 15)] |= 1 << ((u >> 4) & 7);
+      }
+    }
+  }
 
 public:
+  /*!
+   * @throws EmptyPatternError if TA accepts no timed word
+   */
   explicit SundaySkipValue(const TimedAutomaton &TA) {
+    const auto begin = std::chrono::steady_clock::now();
     ZoneAutomaton ZA;
     ta2za(TA, ZA);
+    ta2zaTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
     ZA.removeDeadStates();
 
+    // The characters readable just after reaching each state
+    std::unordered_map<std::size_t, std::vector<char>> firstChars;
+    const auto getFirstChars = [&ZA, &firstChars](std::size_t zaState) -> const std::vector<char> & {
+      auto it = firstChars.find(zaState);
+      if (it != firstChars.end()) {
+        return it->second;
+      }
+      std::unordered_set<std::size_t> closure;
+      closure.insert(zaState);
+      epsilonClosure(ZA, closure);
+      std::array<bool, CHAR_MAX> isFirst{};
+      for (std::size_t state : closure) {
+        for (const auto &edge : ZA.states[state]->next) {
+          if (edge.c > 0 && edge.c < CHAR_MAX) {
+            isFirst[edge.c] = true;
+          }
+        }
+      }
+      std::vector<char> &chars = firstChars[zaState];
+      for (char c = 1; c < CHAR_MAX; c++) {
+        if (isFirst[c]) {
+          chars.push_back(c);
+        }
+      }
+      return chars;
+    };
+
     std::vector<std::unordered_set<char>> charSet;
+    // pairSet[i] is the set of the (i, i+1)-th characters
+    std::vector<std::unordered_set<int>> pairSet;
     bool accepted = false;
     m = 0;
-    std::vector<std::shared_ptr<ZAState>> CStates = ZA.initialStates;
+    std::vector<std::size_t> CStates = ZA.initialIndices();
     while (!accepted) {
       if (CStates.empty()) {
-        std::cerr << "monaa: empty pattern" << std::endl;
-        exit(10);
+        throw EmptyPatternError();
       }
-      std::vector<std::shared_ptr<ZAState>> NStates;
+      std::vector<std::size_t> NStates;
+      std::unordered_set<std::size_t> visited;
       m++;
       charSet.resize(m);
-      for (const auto& zaState : CStates) {
-        std::unordered_set<std::shared_ptr<ZAState>> closure;
+      pairSet.resize(m);
+      for (std::size_t zaState : CStates) {
+        std::unordered_set<std::size_t> closure;
         closure.insert(zaState);
-        epsilonClosure(closure);
-        for (const auto& state : closure) {
-          for (char c = 1; c < CHAR_MAX; c++) {
-            for (const auto& nextState : state->next[c]) {
-              auto sharedNext = nextState.lock();
-              if (!sharedNext) {
-                continue;
-              }
-              accepted = accepted || sharedNext->isMatch;
-              NStates.push_back(sharedNext);
-              charSet[m - 1].insert(c);
+        epsilonClosure(ZA, closure);
+        for (std::size_t state : closure) {
+          for (const auto &edge : ZA.states[state]->next) {
+            const char c = edge.c;
+            if (c <= 0 || c >= CHAR_MAX) {
+              continue;
+            }
+            accepted = accepted || ZA.states[edge.target]->isMatch;
+            if (visited.insert(edge.target).second) {
+              NStates.push_back(edge.target);
+            }
+            charSet[m - 1].insert(c);
+            for (char c2 : getFirstChars(edge.target)) {
+              pairSet[m - 1].insert(c * CHAR_MAX + c2);
             }
           }
         }
@@ -65,16 +167,170 @@ public:
     delta.fill(m + 1);
     for (int i = 0; i <= m - 1; i++) {
       for (char s : charSet[i]) {
-        delta[s] = m - i;
+        delta[index(s)] = m - i;
       }
     }
-    endChars = charSet[m - 1];
+    for (char c : charSet[m - 1]) {
+      addEndChar(c);
+    }
+    makeEndCharNibbles();
+
+    // Construct the table of the q-gram skip value for q = 2. We look at the
+    // two characters just after the window. For the shift n, the first one
+    // is the (m - n)-th character and the second one is the (m - n + 1)-th
+    // character of a matching.
+    qGramDelta.assign((UCHAR_MAX + 1) * (UCHAR_MAX + 1), m + 2);
+    for (int u = 0; u <= UCHAR_MAX; u++) {
+      for (int v = 0; v <= UCHAR_MAX; v++) {
+        const auto a = static_cast<Alphabet>(u), b = static_cast<Alphabet>(v);
+        unsigned int &shift = qGramDelta[qGramIndex(a, b)];
+        if (charSet[m - 1].count(a)) {
+          shift = 1;
+          continue;
+        }
+        for (int i = m - 2; i >= 0; i--) {
+          if (pairSet[i].count(a * CHAR_MAX + b)) {
+            shift = m - i;
+            break;
+          }
+        }
+        if (shift == static_cast<unsigned int>(m + 2) && charSet[0].count(b)) {
+          shift = m + 1;
+        }
+      }
+    }
+
+    // Select the table with the larger average shift, assuming the characters
+    // in the pattern appear uniformly
+    std::array<bool, CHAR_MAX> isUsed{};
+    for (const auto &state : ZA.states) {
+      for (const auto &edge : state->next) {
+        if (edge.c > 0 && edge.c < CHAR_MAX) {
+          isUsed[edge.c] = true;
+        }
+      }
+    }
+    std::vector<char> alphabet;
+    for (char c = 1; c < CHAR_MAX; c++) {
+      if (isUsed[c]) {
+        alphabet.push_back(c);
+      }
+    }
+    double singleShift = 0, qGramShift = 0;
+    for (char a : alphabet) {
+      singleShift += delta[index(a)];
+      for (char b : alphabet) {
+        qGramShift += qGramDelta[qGramIndex(a, b)];
+      }
+    }
+    if (!alphabet.empty()) {
+      singleShift /= alphabet.size();
+      qGramShift /= alphabet.size() * alphabet.size();
+    }
+    isQGram = m > 1 && qGramShift > singleShift;
+    expectedShift = isQGram ? qGramShift : singleShift;
+    if (!isQGram) {
+      qGramDelta.clear();
+    }
+    constructionTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+  }
+  /*!
+   * @brief Restore the skip values computed in advance, e.g., loaded from a compiled pattern
+   */
+  SundaySkipValue(int m, const std::array<unsigned int, UCHAR_MAX + 1> &delta,
+                  const std::array<std::uint64_t, 4> &endCharMask, std::vector<unsigned int> qGramDelta,
+                  bool isQGram, double expectedShift)
+      : m(m), delta(delta), endCharMask(endCharMask), qGramDelta(std::move(qGramDelta)), isQGram(isQGram),
+        expectedShift(expectedShift) {
+    makeEndCharNibbles();
   }
-  unsigned int at(std::size_t n) const { return delta.at(n); }
-  unsigned int operator[](std::size_t n) const { return delta[n]; }
+  unsigned int at(Alphabet c) const { return delta.at(index(c)); }
+  unsigned int operator[](Alphabet c) const { return delta[index(c)]; }
+  /*!
+   * @brief The q-gram skip value
+   *
+   * @param [in] a The first character after the window
+   * @param [in] b The second character after the window
+   * @pre useQGram() is true
+   */
+  unsigned int operator()(Alphabet a, Alphabet b) const { return qGramDelta[qGramIndex(a, b)]; }
+  //! @brief Returns true if the q-gram skip value should be used
+  bool useQGram() const { return isQGram; }
+  //! @brief The average shift of the selected table assuming the characters in the pattern appear uniformly
+  double getExpectedShift() const { return expectedShift; }
   //! @brief Minimum length of the recognized language
   int getM() const { return m; }
+  //! @brief The time to construct the skip value table
+  std::chrono::nanoseconds getConstructionTime() const { return constructionTime; }
+  //! @brief The time to construct the zone automaton, which is included in getConstructionTime()
+  std::chrono::nanoseconds getTa2zaTime() const { return ta2zaTime; }
+  //! @brief The skip value table indexed by a single character as an unsigned byte
+  const std::array<unsigned int, UCHAR_MAX + 1> &getDelta() const { return delta; }
+  //! @brief The q-gram skip value table. This is empty unless useQGram() is true.
+  const std::vector<unsigned int> &getQGramDelta() const { return qGramDelta; }
+  //! @brief The 256-bit membership mask of the end characters
+  const std::array<std::uint64_t, 4> &getEndCharMask() const { return endCharMask; }
   void getEndChars(std::unordered_set<char> &endCharsHolder) const {
-    endCharsHolder = this->endChars;
+    endCharsHolder.clear();
+    for (int c = 0; c <= UCHAR_MAX; c++) {
+      if (isEndChar(static_cast<Alphabet>(c))) {
+        endCharsHolder.insert(static_cast<char>(c));
+      }
+    }
+  }
+  //! @brief Check if c can be the m-th character of a matching
+  bool isEndChar(Alphabet c) const {
+    const auto u = static_cast<unsigned char>(c);
+    return (endCharMask[u >> 6] >> (u & 63)) & 1;
+  }
+  /*!
+   * @brief Find the first end character among the labels of a timed word in memory
+   *
+   * Each label is tested against the end character mask in turn.
+   *
+   * @param [in] label The function returning the label of the n-th event
+   * @returns The first position in [first, last) labelled with an end character, or last if there is no such position.
+   */
+  template <class Label>
+  std::size_t findEndChar(Label label, std::size_t first, std::size_t last) const {
+    for (; first != last; ++first) {
+      if (isEndChar(label(first))) {
+        return first;
+      }
+    }
+    return last;
+  }
+  /*!
+   * @brief Find the first end character in a contiguous column of events
+   *
+   * With AVX2, 32 labels are tested at once: the low nibble of each label selects a row of endCharNibbles by a byte
+   * shuffle, and the high nibble selects a bit of the row. The rest is tested one by one.
+   *
+   * @returns The pointer to the first end character in [first, last), or last if there is no such character.
+   */
+  const Alphabet *findEndChar(const Alphabet *first, const Alphabet *last) const {
+#ifdef __AVX2__
+    const __m256i lowRows =
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(endCharNibbles.data())));
+    const __m256i highRows =
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(endCharNibbles.data() + 16)));
+    const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16,
+                                          32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    for (; last - first >= 32; first += 32) {
+      const __m256i labels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+      const __m256i low = _mm256_and_si256(labels, nibble);
+      const __m256i high = _mm256_and_si256(_mm256_srli_epi16(labels, 4), nibble);
+      // The sign bit of the label chooses the rows for the high nibbles 8--15
+      const __m256i rows =
+          _mm256_blendv_epi8(_mm256_shuffle_epi8(lowRows, low), _mm256_shuffle_epi8(highRows, low), labels);
+      const __m256i hit = _mm256_and_si256(rows, _mm256_shuffle_epi8(bits, high));
+      const auto miss = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+      if (miss != 0xffffffffu) {
+        return first + std::countr_one(miss);
+      }
+    }
+#endif
+    return first + findEndChar([first](std::size_t n) { return first[n]; }, 0, last - first);
   }
 };
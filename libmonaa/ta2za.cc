@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <cstdlib>
 #include <numeric>
+#include <optional>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "ta2za.hh"
 
@@ -18,14 +22,37 @@ void ta2za(const TimedAutomaton &TA, ZoneAutomaton &ZA, Zone initialZone) {
     initialZone = Zone::zero(clockSize + 1);
   }
 
+  /*!
+    @brief The index of the states of ZA by the hash of (TAState, Zone)
+
+    We use this index instead of the linear search over ZA.states.
+  */
+  std::unordered_multimap<std::size_t, std::size_t> toZAState;
+  const auto hashOf = [](const TAState *taState, const Zone &zone) {
+    std::size_t seed = zone.hash();
+    boost::hash_combine(seed, taState);
+    return seed;
+  };
+  const auto findZAState =
+      [&ZA, &toZAState, &hashOf](TAState *taState, const Zone &zone)
+      -> std::optional<std::size_t> {
+    const auto range = toZAState.equal_range(hashOf(taState, zone));
+    for (auto it = range.first; it != range.second; it++) {
+      if (*ZA.states[it->second] == std::make_pair(taState, zone)) {
+        return it->second;
+      }
+    }
+    return std::nullopt;
+  };
+  toZAState.reserve(ZA.states.size());
+  for (std::size_t i = 0; i < ZA.states.size(); ++i) {
+    toZAState.emplace(hashOf(ZA.states[i]->taState, ZA.states[i]->zone), i);
+  }
+
   auto initialStates = TA.initialStates;
   if (!ZA.states.empty()) {
     for (auto it = initialStates.begin(); it != initialStates.end();) {
-      if (std::find_if(ZA.states.begin(), ZA.states.end(),
-                       [&it, &initialZone](std::shared_ptr<ZAState> zaState) {
-                         return *zaState ==
-                                std::make_pair(it->get(), initialZone);
-                       }) != ZA.states.end()) {
+      if (findZAState(it->get(), initialZone)) {
         it = initialStates.erase(it);
       } else {
         it++;
@@ -45,17 +72,54 @@ void ta2za(const TimedAutomaton &TA, ZoneAutomaton &ZA, Zone initialZone) {
     initialZone.M = Bounds(0, true);
   }
 
+  /*!
+    @brief The maximum lower and upper bounds of each clock variable in the guards
+
+    A clock variable not used in any guard is only observed through the zones,
+    e.g., the clock measuring the duration in MatchDuration. For such a clock
+    variable, we use its maxConstraints for both of the bounds.
+  */
+  std::vector<int> L(clockSize, 0), U(clockSize, 0);
+  {
+    std::vector<bool> isGuarded(clockSize, false);
+    for (const auto &state : TA.states) {
+      for (const auto &edges : state->next) {
+        for (const auto &edge : edges.second) {
+          for (const auto &delta : edge.guard) {
+            isGuarded.at(delta.x) = true;
+            switch (delta.odr) {
+            case Constraint::Order::lt:
+            case Constraint::Order::le:
+              U[delta.x] = std::max(U[delta.x], delta.c);
+              break;
+            case Constraint::Order::gt:
+            case Constraint::Order::ge:
+              L[delta.x] = std::max(L[delta.x], delta.c);
+              break;
+            }
+          }
+        }
+      }
+    }
+    for (std::size_t x = 0; x < clockSize; ++x) {
+      if (!isGuarded[x]) {
+        L[x] = U[x] = TA.maxConstraints[x];
+      }
+    }
+  }
+
   /*!
     @brief Make initial state, that is Current configuration of BFS
   */
-  std::vector<std::shared_ptr<ZAState>> nextConf;
+  std::vector<std::size_t> nextConf;
   nextConf.reserve(initialStates.size());
   ZA.states.reserve(ZA.stateSize() + initialStates.size());
   ZA.initialStates.reserve(ZA.initialStates.size() + initialStates.size());
   for (const auto &taState : initialStates) {
     ZA.states.push_back(std::make_shared<ZAState>(taState.get(), initialZone));
+    toZAState.emplace(hashOf(taState.get(), initialZone), ZA.states.size() - 1);
     ZA.initialStates.push_back(ZA.states.back());
-    nextConf.push_back(ZA.states.back());
+    nextConf.push_back(ZA.states.size() - 1);
   }
 
   /*!
@@ -65,11 +129,11 @@ void ta2za(const TimedAutomaton &TA, ZoneAutomaton &ZA, Zone initialZone) {
     (TAState,Zone) -> ZAState
   */
   while (!nextConf.empty()) {
-    std::vector<std::shared_ptr<ZAState>> currentConf = nextConf;
+    std::vector<std::size_t> currentConf = nextConf;
     nextConf.clear();
-    for (const auto &conf : currentConf) {
-      TAState *taState = conf->taState;
-      Zone nowZone = conf->zone;
+    for (const std::size_t conf : currentConf) {
+      TAState *taState = ZA.states[conf]->taState;
+      Zone nowZone = ZA.states[conf]->zone;
       nowZone.elapse();
       for (auto it = taState->next.begin(); it != taState->next.end(); it++) {
         const Alphabet c = it->first;
@@ -100,18 +164,14 @@ void ta2za(const TimedAutomaton &TA, ZoneAutomaton &ZA, Zone initialZone) {
             for (auto x : edge.resetVars) {
               nextZone.reset(x);
             }
-            nextZone.abstractize();
+            nextZone.extrapolate(L, U);
             nextZone.canonize();
             // nextZone state is new
-            const auto targetStateInZA = std::find_if(
-                ZA.states.begin(), ZA.states.end(),
-                [&nextState, &nextZone](std::shared_ptr<ZAState> zaState) {
-                  return *zaState == std::make_pair(nextState, nextZone);
-                });
+            const auto targetStateInZA = findZAState(nextState, nextZone);
 
             // targetStateInZA is already added
-            if (targetStateInZA != ZA.states.end()) {
-              conf->next[c].push_back(*targetStateInZA);
+            if (targetStateInZA) {
+              ZA.states[conf]->next.push_back({c, *targetStateInZA});
 
               //! @todo check if this is necessary
               // ZA.edgeMap[newEdge.toTuple()] = taEdge;
@@ -119,11 +179,13 @@ void ta2za(const TimedAutomaton &TA, ZoneAutomaton &ZA, Zone initialZone) {
               // targetStateInZA is new
               ZA.states.push_back(
                   std::make_shared<ZAState>(nextState, nextZone));
-              conf->next[c].push_back(ZA.states.back());
+              const std::size_t target = ZA.states.size() - 1;
+              toZAState.emplace(hashOf(nextState, nextZone), target);
+              ZA.states[conf]->next.push_back({c, target});
 
               // ZA.edgeMap[newEdge.toTuple()] = taEdge;
 
-              nextConf.push_back(ZA.states.back());
+              nextConf.push_back(target);
             }
           }
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lazy_deque.hh"
+#include <stdexcept>
 #include <vector>
 
 /*!
@@ -67,8 +68,35 @@ public:
     @return It returns true if and only if the fetch succeeded.
   */
   bool fetch(std::size_t n) { return vec.fetch(n); }
+  /*!
+    @brief Find the first position at or after n labelled with an end character of Sunday's skip value.
+    @note This is only for the containers holding the whole timed word in memory (see @link InMemoryContainer
+    @endlink). If the labels are in a contiguous column (see Columns::labels()),
+    they are scanned by the block kernel of the skip value.
+
+    @param [in] delta Sunday's skip value
+    @param [in] n A position in the timed word
+    @return The position, or size() if there is no such position.
+  */
+  template <class SkipValue>
+  std::size_t findEndChar(const SkipValue &delta, std::size_t n) const {
+    if constexpr (requires { vec.labels(); }) {
+      const Alphabet *labels = vec.labels();
+      return delta.findEndChar(labels + n, labels + vec.size()) - labels;
+    } else {
+      return delta.findEndChar([this](std::size_t k) { return vec[k].first; },
+                               n, vec.size());
+    }
+  }
 };
 
+/*!
+  @brief The containers holding the whole timed word in memory, i.e., fetch(n)
+  is just n < size() and setFront() discards nothing.
+*/
+template <class Container>
+concept InMemoryContainer = Container::isInMemory;
+
 /*!
   @class WordLazyDeque
   @brief Word container with runtime allocation and free.
@@ -83,6 +111,7 @@ using WordLazyDeque = WordContainer<LazyDeque>;
 template <class T> class Vector : public std::vector<T> {
 private:
 public:
+  static constexpr bool isInMemory = true;
   Vector(FILE *, bool) {}
   void setFront(std::size_t) {}
   bool fetch(std::size_t n) { return n < this->size(); }
@@ -99,3 +128,185 @@ public:
     }
   }
 };
+
+/*!
+  @class WordSlice
+  @brief Word container referring to a part of a timed word in memory.
+
+  @note The referred timed word must outlive the container. This does not read
+  anything from a file.
+*/
+
+template <class T> class Slice {
+private:
+  const T *first = nullptr;
+  std::size_t length = 0;
+
+public:
+  using value_type = T;
+  static constexpr bool isInMemory = true;
+  Slice(FILE *, bool) {}
+  void assign(const T *newFirst, std::size_t newLength) {
+    first = newFirst;
+    length = newLength;
+  }
+  T operator[](std::size_t n) const { return first[n]; }
+  T at(std::size_t n) const {
+    if (n >= length) {
+      throw std::out_of_range("thrown at Slice::at ");
+    }
+    return first[n];
+  }
+  std::size_t size() const { return length; }
+  void setFront(std::size_t) {}
+  bool fetch(std::size_t n) const { return n < length; }
+};
+
+template <class T> class WordSlice : public WordContainer<Slice<T>> {
+public:
+  /*!
+    @param [in] first The pointer to the first element of the slice
+    @param [in] length The number of the elements in the slice
+   */
+  WordSlice(const T *first, std::size_t length)
+      : WordContainer<Slice<T>>(nullptr, false) {
+    this->vec.assign(first, length);
+  }
+};
+
+/*!
+  @class WordColumns
+  @brief Word container referring to a timed word in memory stored as the
+  arrays of the labels and the timestamps.
+
+  @note The referred arrays must outlive the container. The events are not
+  copied.
+*/
+
+class Columns {
+private:
+  const Alphabet *events = nullptr;
+  const double *timestamps = nullptr;
+  std::size_t length = 0;
+
+public:
+  using value_type = std::pair<Alphabet, double>;
+  static constexpr bool isInMemory = true;
+  Columns(FILE *, bool) {}
+  void assign(const Alphabet *newEvents, const double *newTimestamps,
+              std::size_t newLength) {
+    events = newEvents;
+    timestamps = newTimestamps;
+    length = newLength;
+  }
+  value_type operator[](std::size_t n) const {
+    return {events[n], timestamps[n]};
+  }
+  //! @brief The contiguous array of the labels
+  const Alphabet *labels() const { return events; }
+  value_type at(std::size_t n) const {
+    if (n >= length) {
+      throw std::out_of_range("thrown at Columns::at ");
+    }
+    return {events[n], timestamps[n]};
+  }
+  std::size_t size() const { return length; }
+  void setFront(std::size_t) {}
+  bool fetch(std::size_t n) const { return n < length; }
+};
+
+class WordColumns : public WordContainer<Columns> {
+public:
+  /*!
+    @param [in] events The array of the labels of the events
+    @param [in] timestamps The array of the timestamps of the events
+    @param [in] length The number of the events
+   */
+  WordColumns(const Alphabet *events, const double *timestamps,
+              std::size_t length)
+      : WordContainer<Columns>(nullptr, false) {
+    this->vec.assign(events, timestamps, length);
+  }
+};
+
+/*!
+  @class WordEventBuffer
+  @brief Word container of the events pushed by the caller.
+
+  fetch() fails for the events not pushed yet, and the caller decides if it is
+  the end of the timed word. The events before the front are removed when they
+  are at least a half of the buffer, so the buffer does not allocate memory
+  once it is as large as twice the events between the front and the last.
+*/
+
+template <class T> class EventBuffer {
+private:
+  std::vector<T> events;
+  //! @brief The position of events[0] in the timed word
+  std::size_t offset = 0;
+  std::size_t front = 0;
+  //! @brief The number of the pushed events
+  std::size_t pushed = 0;
+
+public:
+  using value_type = T;
+  EventBuffer(FILE *, bool) {}
+  void push(const T &event) {
+    // The events before the front are not stored.
+    if (pushed++ >= offset) {
+      events.push_back(event);
+    }
+  }
+  T operator[](std::size_t n) const { return events[n - offset]; }
+  T at(std::size_t n) const {
+    if (!fetch(n)) {
+      throw std::out_of_range("thrown at EventBuffer::at ");
+    }
+    return events[n - offset];
+  }
+  std::size_t size() const { return pushed; }
+  void setFront(std::size_t newFront) {
+    if (newFront < offset) {
+      throw std::out_of_range("thrown at EventBuffer::setFront ");
+    }
+    front = newFront;
+    const std::size_t eraseSize = front - offset;
+    if (eraseSize >= events.size()) {
+      events.clear();
+      offset = front;
+    } else if (2 * eraseSize >= events.size()) {
+      events.erase(events.begin(), events.begin() + eraseSize);
+      offset = front;
+    }
+  }
+  bool fetch(std::size_t n) const {
+    return n >= front && n < offset + events.size();
+  }
+  //! @brief Returns the position of the first event kept in the buffer
+  std::size_t getFront() const { return front; }
+  //! @brief Remove all the events. The next pushed event is at the position newSize.
+  void reset(std::size_t newFront, std::size_t newSize) {
+    events.clear();
+    offset = front = newFront;
+    pushed = newSize;
+  }
+};
+
+template <class T>
+class WordEventBuffer : public WordContainer<EventBuffer<T>> {
+public:
+  WordEventBuffer() : WordContainer<EventBuffer<T>>(nullptr, false) {}
+  using WordContainer<EventBuffer<T>>::operator[];
+  T operator[](std::size_t n) const { return this->vec[n]; }
+  bool fetch(std::size_t n) const { return this->vec.fetch(n); }
+  //! @brief Append an event to the timed word
+  void push(const T &event) { this->vec.push(event); }
+  //! @brief Returns the position of the first event kept in the buffer
+  std::size_t getFront() const { return this->vec.getFront(); }
+  /*!
+    @brief Remove all the events and update the front
+
+    The next pushed event is at the position newSize. It is dropped if it is before the front.
+   */
+  void reset(std::size_t newFront, std::size_t newSize) { this->vec.reset(newFront, newSize); }
+};
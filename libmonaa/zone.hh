@@ -10,6 +10,7 @@
 #include <memory>
 #include <tuple>
 #include <vector>
+#include <boost/container_hash/hash.hpp>
 #include <boost/unordered_map.hpp>
 
 #include "common_types.hh"
@@ -66,7 +67,7 @@ struct Zone {
   }
 
   static Zone zero(int size) {
-    static Zone zeroZone;
+    thread_local Zone zeroZone;
     if (zeroZone.value.cols() == size) {
       return zeroZone;
     }
@@ -76,7 +77,7 @@ struct Zone {
   }
 
   static Zone universal(int size) {
-    static Zone zeroZone;
+    thread_local Zone zeroZone;
     static constexpr Bounds infinity =
         Bounds(std::numeric_limits<double>::infinity(), false);
     if (zeroZone.value.cols() == size + 1) {
@@ -163,6 +164,50 @@ struct Zone {
     }
   }
 
+  /*!
+    @brief The LU extrapolation of the zone, i.e., Extra_LU^+ by Behrmann et al.
+
+    Unlike abstractize, the bounds are given for each clock variable and for each direction. A constraint is dropped if
+    it is irrelevant to the guards compared with the clock variables, e.g., an upper bound of x greater than L[x] or
+    a difference x - y when x is greater than L[x].
+
+    @param [in] L The maximum constant c in the guards of the form x > c or x >= c for each clock variable x
+    @param [in] U The maximum constant c in the guards of the form x < c or x <= c for each clock variable x
+    @pre The zone is canonical
+   */
+  void extrapolate(const std::vector<int> &L, const std::vector<int> &U) {
+    static constexpr Bounds infinity =
+        Bounds(std::numeric_limits<double>::infinity(), false);
+    // the constraints of the form 0 - x \le (c, s), i.e., the lower bounds
+    std::vector<Bounds> lowerBounds(value.cols());
+    for (int j = 0; j < value.cols(); ++j) {
+      lowerBounds[j] = value(0, j);
+    }
+    // x is greater than L[x] (resp. U[x]) iff 0 - x < (-L[x], \le)
+    const auto isAboveL = [&](int i) {
+      return lowerBounds[i] < Bounds(-L[i - 1], true);
+    };
+    const auto isAboveU = [&](int i) {
+      return lowerBounds[i] < Bounds(-U[i - 1], true);
+    };
+    for (int j = 1; j < value.cols(); ++j) {
+      if (isAboveU(j)) {
+        value(0, j) = Bounds(-U[j - 1], false);
+      }
+    }
+    for (int i = 1; i < value.rows(); ++i) {
+      for (int j = 0; j < value.cols(); ++j) {
+        if (i == j) {
+          continue;
+        }
+        if (value(i, j) > Bounds(L[i - 1], true) || isAboveL(i) ||
+            (j > 0 && isAboveU(j))) {
+          value(i, j) = infinity;
+        }
+      }
+    }
+  }
+
   /*!
     @brief make the zone unsatisfiable
    */
@@ -204,6 +249,18 @@ struct Zone {
     return value == z.value;
   }
 
+  /*!
+    @brief A hash value consistent with operator==, i.e., (0, 0) is ignored
+   */
+  std::size_t hash() const {
+    std::size_t seed = value.size();
+    for (auto it = value.data() + 1; it < value.data() + value.size(); it++) {
+      boost::hash_combine(seed, std::hash<double>{}(it->first));
+      boost::hash_combine(seed, it->second);
+    }
+    return seed;
+  }
+
   void intersectionAssign(Zone z) {
     assert(value.size() == z.value.size());
     value.cwiseMin(z.value);
@@ -2,27 +2,44 @@
 
 #include "timed_automaton.hh"
 #include "zone.hh"
-#include <stack>
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
+//! @brief A transition of zone automata
+struct ZATransition {
+  //! @brief The label. An epsilon transition is denoted by the null character (\0)
+  Alphabet c;
+  //! @brief The index of the target state in ZoneAutomaton::states
+  std::size_t target;
+};
+
 struct ZAState {
   bool isMatch;
-  // An epsilon transition is denoted by the null character (\0)
-  std::array<std::vector<std::weak_ptr<ZAState>>, CHAR_MAX> next;
+  /*!
+    @brief The outgoing transitions
+
+    Most of the states have only a few outgoing transitions, so we keep them in
+    a flat list rather than a table indexed by the labels.
+   */
+  std::vector<ZATransition> next;
   TAState *taState;
   Zone zone;
-  ZAState() : isMatch(false), next({}) {}
+  ZAState() : isMatch(false) {}
   ZAState(TAState *taState, Zone zone)
-      : isMatch(taState->isMatch), next({}), taState(taState),
-        zone(std::move(zone)) {}
-  ZAState(bool isMatch) : isMatch(isMatch), next({}) {}
-  ZAState(bool isMatch,
-          std::array<std::vector<std::weak_ptr<ZAState>>, CHAR_MAX> next)
-      : isMatch(isMatch), next(next) {}
+      : isMatch(taState->isMatch), taState(taState), zone(std::move(zone)) {}
+  ZAState(bool isMatch) : isMatch(isMatch) {}
+  ZAState(bool isMatch, std::vector<ZATransition> next)
+      : isMatch(isMatch), next(std::move(next)) {}
   bool operator==(std::pair<TAState *, Zone> pair) {
     return pair.first == taState && pair.second == zone;
   }
+  //! @brief Returns true if there is a transition labelled with c
+  bool hasTransition(Alphabet c) const {
+    return std::any_of(next.begin(), next.end(),
+                       [c](const ZATransition &edge) { return edge.c == c; });
+  }
 };
 
 struct NoEpsilonZAState {
@@ -34,81 +51,111 @@ struct NoEpsilonZAState {
   }
 };
 
-//! @brief returns the set of states that is reachable from a state in the state
-//! by unobservable transitions
-static inline void
-epsilonClosure(std::unordered_set<std::shared_ptr<ZAState>> &closure) {
-  auto waiting =
-      std::deque<std::shared_ptr<ZAState>>(closure.begin(), closure.end());
-  while (!waiting.empty()) {
-    for (auto wstate : waiting.front()->next[0]) {
-      auto state = wstate.lock();
-      if (state && closure.find(state) == closure.end()) {
-        closure.insert(state);
-        waiting.push_back(state);
-      }
-    }
-    waiting.pop_front();
-  }
-}
-
 struct ZoneAutomaton : public Automaton<ZAState> {
   using State = ::ZAState;
 
-  //! @brief remove states unreachable to any accepting states
+  /*!
+    @brief remove states unreachable to any accepting states
+
+    We keep the states reachable from an initial state and reachable to an
+    accepting state. Both of them are computed by a graph search, the latter on
+    the reversed graph, in time linear to the size of the zone automaton.
+  */
   void removeDeadStates() {
-    // Find states unreachable to any accepting states
-    using Config = std::pair<std::shared_ptr<ZAState>,
-                             std::unordered_set<std::shared_ptr<ZAState>>>;
-    std::stack<Config> States;
-    for (auto state : initialStates) {
-      States.push(Config(state, {}));
-    }
-    std::unordered_set<std::shared_ptr<ZAState>> reachable;
-    while (!States.empty()) {
-      Config conf = States.top();
-      States.pop();
-      if (conf.first->isMatch) {
-        reachable.insert(conf.first);
-        reachable.insert(conf.second.begin(), conf.second.end());
+    // Find states reachable from the initial states
+    std::vector<bool> forward(states.size(), false);
+    std::vector<std::size_t> waiting;
+    for (std::size_t i : initialIndices()) {
+      if (!forward[i]) {
+        forward[i] = true;
+        waiting.push_back(i);
       }
-      for (const auto &edges : conf.first->next) {
-        for (const auto &edge : edges) {
-          if (conf.second.find(conf.first) != conf.second.end()) {
-            // We are in a loop
-            continue;
-          }
-          if (reachable.find(edge.lock()) != reachable.end()) {
-            // The next state is reachable
-            reachable.insert(conf.first);
-            reachable.insert(conf.second.begin(), conf.second.end());
-          } else {
-            // The next state may be unreachable
-            auto parents = conf.second;
-            parents.insert(conf.first);
-            States.push(Config(edge.lock(), parents));
-          }
+    }
+    // The reversed edges between the states reachable from the initial states
+    std::vector<std::vector<std::size_t>> previous(states.size());
+    while (!waiting.empty()) {
+      const std::size_t i = waiting.back();
+      waiting.pop_back();
+      for (const auto &edge : states[i]->next) {
+        previous[edge.target].push_back(i);
+        if (!forward[edge.target]) {
+          forward[edge.target] = true;
+          waiting.push_back(edge.target);
         }
       }
     }
 
+    // Find states reachable to any accepting states
+    std::vector<bool> backward(states.size(), false);
+    for (std::size_t i = 0; i < states.size(); ++i) {
+      if (forward[i] && states[i]->isMatch) {
+        backward[i] = true;
+        waiting.push_back(i);
+      }
+    }
+    while (!waiting.empty()) {
+      const std::size_t i = waiting.back();
+      waiting.pop_back();
+      for (std::size_t j : previous[i]) {
+        if (!backward[j]) {
+          backward[j] = true;
+          waiting.push_back(j);
+        }
+      }
+    }
     // Remove unreachable states
-    for (auto it = states.begin(); it != states.end();) {
-      if (reachable.find(*it) == reachable.end()) {
-        it = states.erase(it);
-      } else {
-        it++;
+    std::vector<std::shared_ptr<ZAState>> newInitialStates;
+    for (std::size_t i : initialIndices()) {
+      if (backward[i]) {
+        newInitialStates.push_back(states[i]);
       }
     }
-    for (auto it = initialStates.begin(); it != initialStates.end();) {
-      if (reachable.find(*it) == reachable.end()) {
-        it = initialStates.erase(it);
-      } else {
-        it++;
+    initialStates = std::move(newInitialStates);
+    // The index of each state after the removal. The removed states are mapped to removed.
+    const std::size_t removed = states.size();
+    std::vector<std::size_t> newIndex(states.size(), removed);
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < states.size(); ++i) {
+      if (backward[i]) {
+        newIndex[i] = size;
+        if (size != i) {
+          states[size] = std::move(states[i]);
+        }
+        size++;
+      }
+    }
+    states.resize(size);
+    for (auto &state : states) {
+      auto &edges = state->next;
+      edges.erase(std::remove_if(edges.begin(), edges.end(),
+                                 [&](const ZATransition &edge) {
+                                   return newIndex[edge.target] == removed;
+                                 }),
+                  edges.end());
+      for (auto &edge : edges) {
+        edge.target = newIndex[edge.target];
       }
     }
   }
 
+  //! @brief Returns the indices of the initial states in states
+  std::vector<std::size_t> initialIndices() const {
+    std::unordered_map<const ZAState *, std::size_t> toIndex;
+    toIndex.reserve(states.size());
+    for (std::size_t i = 0; i < states.size(); ++i) {
+      toIndex[states[i].get()] = i;
+    }
+    std::vector<std::size_t> result;
+    result.reserve(initialStates.size());
+    for (const auto &state : initialStates) {
+      auto it = toIndex.find(state.get());
+      if (it != toIndex.end()) {
+        result.push_back(it->second);
+      }
+    }
+    return result;
+  }
+
   /*!
     @brief Propagate accepting states from the original timed automaton
     @note taInitSates must be sorted
@@ -134,23 +181,22 @@ struct ZoneAutomaton : public Automaton<ZAState> {
 
   //! @brief emptiness check of the language
   bool empty() const {
-    std::vector<std::shared_ptr<ZAState>> currentStates = initialStates;
-    std::unordered_set<std::shared_ptr<ZAState>> visited = {
-        initialStates.begin(), initialStates.end()};
+    std::vector<std::size_t> currentStates = initialIndices();
+    std::vector<bool> visited(states.size(), false);
+    for (std::size_t i : currentStates) {
+      visited[i] = true;
+    }
     while (!currentStates.empty()) {
-      std::vector<std::shared_ptr<ZAState>> nextStates;
-      for (auto state : currentStates) {
-        if (state->isMatch) {
+      std::vector<std::size_t> nextStates;
+      for (std::size_t i : currentStates) {
+        if (states[i]->isMatch) {
           return false;
         }
-        for (const auto &edges : state->next) {
-          for (const auto &edge : edges) {
-            auto target = edge.lock();
-            if (target && visited.find(target) == visited.end()) {
-              // We have not visited the state
-              nextStates.push_back(target);
-              visited.insert(target);
-            }
+        for (const auto &edge : states[i]->next) {
+          if (!visited[edge.target]) {
+            // We have not visited the state
+            nextStates.push_back(edge.target);
+            visited[edge.target] = true;
           }
         }
       }
@@ -159,3 +205,20 @@ struct ZoneAutomaton : public Automaton<ZAState> {
     return true;
   }
 };
+
+//! @brief returns the set of states that is reachable from a state in the state
+//! by unobservable transitions
+//! @param [in,out] closure The indices of the states in ZA.states
+static inline void epsilonClosure(const ZoneAutomaton &ZA,
+                                  std::unordered_set<std::size_t> &closure) {
+  std::vector<std::size_t> waiting(closure.begin(), closure.end());
+  while (!waiting.empty()) {
+    const std::size_t i = waiting.back();
+    waiting.pop_back();
+    for (const auto &edge : ZA.states[i]->next) {
+      if (edge.c == 0 && closure.insert(edge.target).second) {
+        waiting.push_back(edge.target);
+      }
+    }
+  }
+}
@@ -550,18 +550,24 @@ void AtomicTRE::toSignalTA(TimedAutomaton &out) const {
     expr->toSignalTA(out);
     for (auto &s : out.states) {
       for (auto &edges : s->next) {
-        for (auto &edge : edges.second) {
+        std::vector<TATransition> newTransitions;
+        for (const auto &edge : edges.second) {
           TAState *target = edge.target;
           if (target && target->isMatch) {
-            edges.second.reserve(edges.second.size() +
-                                 out.initialStates.size());
+            newTransitions.reserve(newTransitions.size() +
+                                   out.initialStates.size());
             for (auto initState : out.initialStates) {
               TATransition transition = edge;
-              edge.target = target;
-              edges.second.emplace_back(std::move(transition));
+              transition.target = initState.get();
+              for (std::size_t clock = 0; clock < out.clockSize(); clock++) {
+                transition.resetVars.push_back(clock);
+              }
+              newTransitions.emplace_back(std::move(transition));
             }
           }
         }
+        edges.second.insert(edges.second.end(), newTransitions.begin(),
+                            newTransitions.end());
       }
     }
     break;
@@ -1,7 +1,15 @@
 #include <boost/program_options.hpp>
+#include <chrono>
 #include <iostream>
+#include <ranges>
+#include <unordered_map>
 
+#include "keyed_monaa.hh"
+#include "match_stats.hh"
 #include "monaa.hh"
+#include "parallel_monaa.hh"
+#include "pipeline.hh"
+#include "state_minimization.hh"
 #include "timed_automaton_parser.hh"
 #include "tre_driver.hh"
 
@@ -23,11 +31,11 @@ int main(int argc, char *argv[]) {
   // visible options
   options_description visible("description of options");
   std::string timedWordFileName;
-  std::string timedAutomatonFileName;
-  std::string tre;
-  std::stringstream treStream;
+  std::string outputFileName;
   bool isBinary = false;
   bool isSignal = false;
+  std::size_t jobs = 1;
+  std::string statsFormat;
   visible.add_options()
     ("help,h", "help")
     ("quiet,q", "quiet")
@@ -36,9 +44,18 @@ int main(int argc, char *argv[]) {
     ("binary,b", "binary mode (experimental)")
     ("event,E", "event mode [default]")
     ("signal,S", "signal mode (experimental)")
+    ("jobs,j", value<std::size_t>(&jobs)->default_value(1), "number of threads to match the whole log in parallel (experimental)")
+    ("merge", "match all the patterns with one merged automaton [default for many patterns in the event mode without -j] (experimental)")
+    ("pipeline", "read, match, and print in three threads (experimental)")
+    ("keyed", "match the timed word of each key in the first column independently (experimental)")
+    ("stats", value<std::string>(&statsFormat)->implicit_value("text"), "print the statistics of the run to stderr (text or json)")
     ("input,i", value<std::string>(&timedWordFileName)->default_value("stdin"), "input file of Timed Words")
-    ("automaton,f", value<std::string>(&timedAutomatonFileName)->default_value(""), "input file of Timed Automaton")
-    ("expression,e", value<std::string>(&tre)->default_value(""), "pattern Timed Regular Expression");
+    ("automaton,f", value<std::vector<std::string>>(), "input file of Timed Automaton")
+    ("expression,e", value<std::vector<std::string>>(), "pattern Timed Regular Expression")
+    ("expression-file", value<std::vector<std::string>>(), "input file of Timed Regular Expressions, one per line")
+    ("pattern,p", value<std::vector<std::string>>(), "input file of compiled pattern")
+    ("compile", "compile the pattern and write it to the output file")
+    ("output,o", value<std::string>(&outputFileName)->default_value(""), "output file of compiled pattern");
 
   command_line_parser parser(argc, argv);
   parser.options(visible);
@@ -47,10 +64,33 @@ int main(int argc, char *argv[]) {
   store(parseResult, vm);
   notify(vm);
 
+  // The patterns in the order in the command line. The ID of a pattern is its index.
+  enum class PatternKind { expression, automaton, compiled };
+  std::vector<std::pair<PatternKind, std::string>> patternSources;
+  for (const auto &option : parseResult.options) {
+    if (option.string_key == "expression") {
+      patternSources.emplace_back(PatternKind::expression, option.value.front());
+    } else if (option.string_key == "automaton") {
+      patternSources.emplace_back(PatternKind::automaton, option.value.front());
+    } else if (option.string_key == "pattern") {
+      patternSources.emplace_back(PatternKind::compiled, option.value.front());
+    } else if (option.string_key == "expression-file") {
+      std::ifstream expressionStream(option.value.front());
+      if (!expressionStream) {
+        die("failed to open the file of the patterns", 1);
+      }
+      for (std::string line; std::getline(expressionStream, line);) {
+        if (!line.empty()) {
+          patternSources.emplace_back(PatternKind::expression, std::move(line));
+        }
+      }
+    }
+  }
+
   for (auto const &str :
        collect_unrecognized(parseResult.options, include_positional)) {
-    if (timedAutomatonFileName.empty() && tre.empty()) {
-      tre = std::move(str);
+    if (patternSources.empty()) {
+      patternSources.emplace_back(PatternKind::expression, std::move(str));
     } else if (timedWordFileName == "stdin") {
       timedWordFileName = std::move(str);
     }
@@ -73,10 +113,15 @@ int main(int argc, char *argv[]) {
         << std::endl;
     return 0;
   }
-  if ((timedAutomatonFileName.empty() && tre.empty()) || vm.count("help")) {
+  if (patternSources.empty() || vm.count("help")) {
     std::cout << programName << " [OPTIONS] PATTERN [FILE]\n"
               << programName << " [OPTIONS] -e PATTERN [FILE]\n"
               << programName << " [OPTIONS] -f FILE [FILE]\n"
+              << programName << " [OPTIONS] -p FILE [FILE]\n"
+              << programName << " [OPTIONS] -e PATTERN -e PATTERN ... [FILE]\n"
+              << programName << " [OPTIONS] --expression-file FILE [FILE]\n"
+              << programName << " [OPTIONS] --compile -e PATTERN -o FILE\n"
+              << programName << " [OPTIONS] --compile -f FILE -o FILE\n"
               << visible << std::endl;
     return 0;
   }
@@ -94,33 +139,147 @@ int main(int argc, char *argv[]) {
   } else if (vm.count("event")) {
     isSignal = false;
   }
-  if (!timedAutomatonFileName.empty() && !tre.empty()) {
-    die("both a timed automaton and a timed regular expression are specified", 1);
+  if (vm.count("compile") && patternSources.size() > 1) {
+    die("more than one pattern is specified for the compilation", 1);
+  }
+  if (vm.count("compile") && patternSources.front().first == PatternKind::compiled) {
+    die("the pattern is already compiled", 1);
+  }
+  if (vm.count("merge") && jobs != 1) {
+    die("the merged patterns cannot be matched in parallel", 1);
+  }
+  if (vm.count("pipeline") && jobs != 1) {
+    die("the pipeline is only for the online matching", 1);
+  }
+  if (vm.count("keyed") && (patternSources.size() > 1 || vm.count("merge") || vm.count("pipeline"))) {
+    die("the keyed input is only for one pattern", 1);
+  }
+  if (vm.count("keyed") && isBinary) {
+    die("the keyed input is only in the ascii mode", 1);
+  }
+  if (vm.count("compile") && outputFileName.empty()) {
+    die("no output file is specified for the compiled pattern", 1);
+  }
+  if (vm.count("stats") && statsFormat != "text" && statsFormat != "json") {
+    die("the format of the statistics must be text or json", 1);
   }
 
-  TimedAutomaton TA;
+  // The statistics printed by --stats
+  MatchStats stats;
+  const auto measure = [](std::chrono::nanoseconds &time, auto &&f) {
+    const auto begin = std::chrono::steady_clock::now();
+    f();
+    time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+  };
+  // The times are zero and the clock variables are not reduced for a pattern compiled in advance.
+  const auto addCompileStats = [&stats](const CompiledPattern &pattern) {
+    stats.ta2za += pattern.delta.getTa2zaTime() + pattern.beta.getTa2zaTime();
+    stats.sunday += pattern.delta.getConstructionTime();
+    stats.kmp += pattern.beta.getConstructionTime();
+    stats.clocks.before += pattern.clocks.before;
+    stats.clocks.after += pattern.clocks.after;
+  };
 
-  if (timedAutomatonFileName.empty()) {
-    // parse TRE
-    TREDriver driver;
-    treStream << tre.c_str();
-    if (!driver.parse(treStream)) {
-      die("Failed to parse TRE", 2);
+  std::vector<std::unique_ptr<CompiledPattern>> patterns;
+  patterns.reserve(patternSources.size());
+  // Many patterns are matched online with their union unless they are matched
+  // in parallel or in the signal mode. Then, the parsed patterns are not
+  // compiled one by one because the skip values are computed only for the
+  // union. The mode is fixed by the first pattern, so this is decided before
+  // the second one.
+  const auto isMerged = [&] {
+    return patternSources.size() > 1 && jobs == 1 &&
+           (vm.count("merge") || !isSignal);
+  };
+  std::vector<TimedAutomaton> parsedAutomata;
+  parsedAutomata.reserve(patternSources.size());
+  std::vector<const TimedAutomaton *> automata;
+  StateMinimization states{0, 0};
+  bool isModeSpecified = vm.count("signal") || vm.count("event");
+  for (const auto &source : patternSources) {
+    if (source.first == PatternKind::compiled) {
+      std::unique_ptr<CompiledPattern> pattern;
+      try {
+        measure(stats.parse, [&] { pattern = loadCompiledPattern(source.second); });
+      } catch (const std::runtime_error &e) {
+        die(e.what(), 2);
+      }
+      const bool isSignalPattern = pattern->mode == CompiledPattern::Mode::signal;
+      if (isModeSpecified && isSignal != isSignalPattern) {
+        die("the compiled pattern is for a different mode", 1);
+      }
+      isSignal = isSignalPattern;
+      isModeSpecified = true;
+      // The states were minimized at the compilation.
+      stats.states.before += pattern->automaton.stateSize();
+      stats.states.after += pattern->automaton.stateSize();
+      if (isMerged()) {
+        automata.push_back(&pattern->automaton);
+      } else {
+        addCompileStats(*pattern);
+      }
+      patterns.push_back(std::move(pattern));
+      continue;
     }
-    if (isSignal) {
-      toSignalTA(driver.getResult(), TA);
+    TimedAutomaton TA;
+    if (source.first == PatternKind::expression) {
+      // parse TRE
+      TREDriver driver;
+      std::stringstream treStream;
+      treStream << source.second.c_str();
+      bool isParsed = false;
+      measure(stats.parse, [&] { isParsed = driver.parse(treStream); });
+      if (!isParsed) {
+        die("Failed to parse TRE", 2);
+      }
+      measure(stats.build, [&] {
+        if (isSignal) {
+          toSignalTA(driver.getResult(), TA);
+        } else {
+          driver.getResult()->toEventTA(TA);
+        }
+      });
     } else {
-      driver.getResult()->toEventTA(TA);
+      if (isSignal) {
+        die("signal-mode is not supported only for TAs", 1);
+      }
+      // parse TA
+      std::ifstream taStream(source.second);
+      BoostTimedAutomaton BoostTA;
+      measure(stats.parse, [&] { parseBoostTA(taStream, BoostTA); });
+      measure(stats.build, [&] { convBoostTA(BoostTA, TA); });
     }
-  } else {
-    if (isSignal) {
-      die("signal-mode is not supported only for TAs", 1);
+    measure(stats.build, [&] { states = minimizeStates(TA); });
+    stats.states.before += states.before;
+    stats.states.after += states.after;
+    isModeSpecified = true;
+    if (isMerged()) {
+      parsedAutomata.push_back(std::move(TA));
+      automata.push_back(&parsedAutomata.back());
+      continue;
+    }
+    try {
+      patterns.push_back(std::make_unique<CompiledPattern>(
+          std::move(TA), isSignal ? CompiledPattern::Mode::signal : CompiledPattern::Mode::event));
+    } catch (const EmptyPatternError &e) {
+      die(e.what(), 10);
     }
-    // parse TA
-    std::ifstream taStream(timedAutomatonFileName);
-    BoostTimedAutomaton BoostTA;
-    parseBoostTA(taStream, BoostTA);
-    convBoostTA(BoostTA, TA);
+    addCompileStats(*patterns.back());
+  }
+
+  if (vm.count("compile")) {
+    try {
+      saveCompiledPattern(*patterns.front(), outputFileName);
+    } catch (const std::runtime_error &e) {
+      die(e.what(), 1);
+    }
+    if (!vm.count("quiet")) {
+      std::cerr << errorHeader << "states: " << states.before << " -> "
+                << states.after << std::endl;
+      std::cerr << errorHeader << "clock variables: " << patterns.front()->clocks.before
+                << " -> " << patterns.front()->clocks.after << std::endl;
+    }
+    return 0;
   }
 
   FILE *file = stdin;
@@ -131,14 +290,145 @@ int main(int argc, char *argv[]) {
       return 1;
     }
   }
-  AnsPrinter ans(vm.count("quiet"));
+  const auto readWord = [&] {
+    std::vector<std::pair<Alphabet, double>> word;
+    measure(stats.read, [&] {
+      const auto getElem = isBinary ? getOneBinary : getOne;
+      std::pair<Alphabet, double> elem;
+      while (getElem(file, elem) != EOF) {
+        word.push_back(elem);
+      }
+    });
+    stats.events = word.size();
+    return word;
+  };
+  // Print the statistics after the matching
+  const auto printStats = [&](const auto &answers) {
+    if (!vm.count("stats")) {
+      return;
+    }
+    const long position = ftell(file);
+    if (position >= 0) {
+      stats.bytes = position;
+    }
+    if (stats.counters) {
+      stats.events = stats.counters->events;
+    }
+    for (const auto &ans : answers) {
+      stats.zones += ans.size();
+    }
+    if (statsFormat == "json") {
+      stats.printJSON(std::cerr);
+    } else {
+      stats.print(std::cerr, std::string(errorHeader) + "stats: ");
+    }
+  };
+  if (vm.count("keyed")) {
+    // match the timed word of each key independently as the events are read
+    if (isSignal) {
+      die("the keyed input is only in the event mode", 1);
+    }
+    // the zones of each key preceded by the line "key: " and the key
+    std::unordered_map<std::string, PrintContainer> answers;
+    const auto print = [&](const std::string &key, const Zone &zone) {
+      answers.try_emplace(key, vm.count("quiet"), "key: " + key).first->second.push_back(zone);
+    };
+    std::unique_ptr<KeyedMonitor> monitor;
+    try {
+      monitor = std::make_unique<KeyedMonitor>(std::move(patterns.front()), print, jobs);
+    } catch (const std::invalid_argument &e) {
+      die(e.what(), 1);
+    }
+    measure(stats.match, [&] { stats.events = keyedMonaa(file, *monitor); });
+    printStats(std::views::values(answers));
+    return 0;
+  }
+  if (isMerged()) {
+    if (isSignal) {
+      die("the patterns can be merged only in the event mode", 1);
+    }
+    // match the log online with the union of the patterns
+    std::vector<AnsPrinter> answers;
+    for (std::size_t k = 0; k < automata.size(); ++k) {
+      answers.emplace_back(PrintContainer(vm.count("quiet"), k));
+    }
+    std::unique_ptr<MergedPattern> merged;
+    try {
+      merged = std::make_unique<MergedPattern>(automata, CompiledPattern::Mode::event);
+    } catch (const EmptyPatternError &e) {
+      die(e.what(), 10);
+    }
+    addCompileStats(merged->pattern);
+    automata.clear();
+    parsedAutomata.clear();
+    patterns.clear();
+    MatchCounters *counters = vm.count("stats") ? &stats.counters.emplace() : nullptr;
+    if (vm.count("pipeline")) {
+      measure(stats.match, [&] {
+        pipelineMonaa(file, isBinary, answers, [&](WordRingDeque w, std::vector<AnsRing> &ans) {
+          monaaMerged(std::move(w), *merged, ans, counters);
+        });
+      });
+      printStats(answers);
+      return 0;
+    }
+    WordLazyDeque w(file, isBinary);
+    measure(stats.match, [&] { monaaMerged(w, *merged, answers, counters); });
+    printStats(answers);
+    return 0;
+  }
+  if (patterns.size() > 1 && vm.count("pipeline")) {
+    die("the pipeline is not supported for many patterns in the signal mode", 1);
+  }
+  if (patterns.size() > 1) {
+    // read the whole log once and match it with all the patterns
+    const auto word = readWord();
+    std::vector<const CompiledPattern *> patternPointers;
+    std::vector<AnsPrinter> answers;
+    for (std::size_t k = 0; k < patterns.size(); ++k) {
+      patternPointers.push_back(patterns[k].get());
+      answers.emplace_back(PrintContainer(vm.count("quiet"), k));
+    }
+    MatchCounters *counters = vm.count("stats") ? &stats.counters.emplace() : nullptr;
+    measure(stats.match, [&] { multiMonaa(word, patternPointers, answers, jobs, counters); });
+    printStats(answers);
+    return 0;
+  }
+  const CompiledPattern &pattern = *patterns.front();
+  std::vector<AnsPrinter> answers = {AnsPrinter(vm.count("quiet"))};
+  AnsPrinter &ans = answers.front();
+  MatchCounters *counters = vm.count("stats") ? &stats.counters.emplace() : nullptr;
+  if (jobs != 1) {
+    // read the whole log and match its chunks in parallel
+    const auto word = readWord();
+    measure(stats.match, [&] { parallelMonaa(word, pattern, ans, jobs, counters); });
+    printStats(answers);
+    return 0;
+  }
+  if (vm.count("pipeline")) {
+    // online mode with the reader and the writer threads
+    measure(stats.match, [&] {
+      pipelineMonaa(file, isBinary, answers, [&](WordRingDeque w, std::vector<AnsRing> &ringAns) {
+        if (isSignal) {
+          monaa(std::move(w), pattern, ringAns.front(), counters);
+        } else {
+          monaaDollar(std::move(w), pattern, ringAns.front(), counters);
+        }
+      });
+    });
+    printStats(answers);
+    return 0;
+  }
   // online mode
   WordLazyDeque w(file, isBinary);
-  if (vm.count("signal")) {
-    monaa(w, TA, ans);
-  } else {
-    monaaDollar(w, TA, ans);
-  }
+  measure(stats.match, [&] {
+    if (isSignal) {
+      monaa(w, pattern, ans, counters);
+    } else {
+      monaaDollar(w, pattern, ans, counters);
+    }
+  });
+  printStats(answers);
 
   return 0;
 }
@@ -287,7 +287,7 @@ void TRE::toEventTA(TimedAutomaton &out) const {
         toIState;
     regExprPair.first->toEventTA(tmpTA);
     regExprPair.second->toEventTA(another);
-    intersectionTA(tmpTA, another, out, toIState);
+    reachableIntersectionTA(tmpTA, another, out, toIState);
     break;
   }
   case op::within: {
@@ -0,0 +1,88 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/batch_monaa.hh"
+#include "../libmonaa/online_monitor.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(batchMonaaTest)
+
+struct BatchMonaaFixture {
+  std::vector<std::pair<Alphabet, double>> word = makeRandomTimedWord();
+  std::vector<Alphabet> events;
+  std::vector<double> timestamps;
+  TimedAutomaton TA;
+
+  BatchMonaaFixture() {
+    // The same timed word in columns
+    for (const auto &[c, t] : word) {
+      events.push_back(c);
+      timestamps.push_back(t);
+    }
+  }
+
+  void check(const CompiledPattern &pattern) {
+    AnsVec<Zone> expected;
+    if (pattern.mode == CompiledPattern::Mode::signal) {
+      monaa(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, expected);
+    } else {
+      monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, expected);
+    }
+    BOOST_TEST(expected.size() > 10);
+
+    // Too small buffer
+    std::vector<Zone> result(10);
+    BOOST_CHECK_EQUAL(batchMonaa(events.data(), timestamps.data(), events.size(), pattern, result.data(), result.size()),
+                      expected.size());
+    auto it = expected.begin();
+    for (const Zone &zone : result) {
+      BOOST_TEST(bool(zone == *it++));
+    }
+
+    result.resize(expected.size());
+    BOOST_CHECK_EQUAL(batchMonaa(events.data(), timestamps.data(), events.size(), pattern, result.data(), result.size()),
+                      expected.size());
+    it = expected.begin();
+    for (const Zone &zone : result) {
+      BOOST_TEST(bool(zone == *it++));
+    }
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(event, BatchMonaaFixture) {
+  makeReferenceTA(TA, '$');
+  check(CompiledPattern(TA, CompiledPattern::Mode::event));
+}
+
+BOOST_FIXTURE_TEST_CASE(signal, BatchMonaaFixture) {
+  makeReferenceTA(TA, 'c');
+  check(CompiledPattern(TA, CompiledPattern::Mode::signal));
+}
+
+BOOST_FIXTURE_TEST_CASE(sparseEndChars, BatchMonaaFixture) {
+  // The end character 'b' is rare, and the labels between them are scanned against the mask. The online monitor does
+  // not scan the labels because they are not in memory.
+  for (std::size_t k = 0; k < events.size(); ++k) {
+    if (events[k] == 'b' && k % 97 != 0) {
+      events[k] = 'c';
+    }
+  }
+  makeReferenceTA(TA, '$');
+  const CompiledPattern pattern(TA, CompiledPattern::Mode::event);
+  AnsVec<Zone> expected;
+  OnlineMonitor monitor(pattern, [&](const Zone &zone) { expected.push_back(zone); });
+  monitor.feedBatch(std::span<const Alphabet>(events), std::span<const double>(timestamps));
+  monitor.finish();
+  BOOST_TEST(expected.size() > 0);
+
+  WordColumns columns(events.data(), timestamps.data(), events.size());
+  BOOST_CHECK_EQUAL(columns.findEndChar(pattern.delta, 0), std::find(events.begin(), events.end(), 'b') - events.begin());
+  AnsVec<Zone> result;
+  batchMonaa(events.data(), timestamps.data(), events.size(), pattern, result);
+  BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+  auto it = expected.begin();
+  for (const Zone &zone : result) {
+    BOOST_TEST(bool(zone == *it++));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/timed_automaton.hh"
+#include "../libmonaa/clock_reduction.hh"
+
+BOOST_AUTO_TEST_SUITE(clockReductionTests)
+
+class TAFixture {
+public:
+  TimedAutomaton TA;
+  TAFixture() {
+    TA.states.resize(3);
+    for (auto &state: TA.states) {
+      state = std::make_shared<TAState>();
+    }
+
+    TA.initialStates = {TA.states[0]};
+
+    TA.states[0]->isMatch = false;
+    TA.states[1]->isMatch = false;
+    TA.states[2]->isMatch = true;
+
+    // Transitions
+    // x0 and x2 are always equal, x1 is inactive, and x3 is never reset and live with x0 and x2
+    TA.states[0]->next['a'].push_back({TA.states[1].get(), {0, 1, 2}, {{TimedAutomaton::X(3) < 5}}});
+    TA.states[1]->next['b'].push_back({TA.states[1].get(), {0, 2}, {{TimedAutomaton::X(0) < 1}}});
+    TA.states[1]->next['c'].push_back({TA.states[2].get(), {1}, {{TimedAutomaton::X(2) > 2, TimedAutomaton::X(3) < 5}}});
+
+    TA.maxConstraints = {1, 0, 2, 5};
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE( reduceClocksTest, TAFixture )
+{
+  const ClockReduction result = reduceClocks(TA);
+
+  BOOST_CHECK_EQUAL(result.before, 4);
+  BOOST_CHECK_EQUAL(result.after, 2);
+  BOOST_REQUIRE_EQUAL(TA.clockSize(), 2);
+  BOOST_CHECK_EQUAL(TA.maxConstraints[0], 2);
+  BOOST_CHECK_EQUAL(TA.maxConstraints[1], 5);
+
+  const auto &a = TA.states[0]->next['a'].front();
+  BOOST_CHECK(a.resetVars == std::vector<ClockVariables>{0});
+  BOOST_CHECK_EQUAL(a.guard.front().x, 1);
+  const auto &b = TA.states[1]->next['b'].front();
+  BOOST_CHECK(b.resetVars == std::vector<ClockVariables>{0});
+  BOOST_CHECK_EQUAL(b.guard.front().x, 0);
+  const auto &c = TA.states[1]->next['c'].front();
+  BOOST_CHECK(c.resetVars.empty());
+  BOOST_CHECK_EQUAL(c.guard.front().x, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE( irreducibleTest, TAFixture )
+{
+  TA.states[1]->next['b'].front().resetVars = {0};
+  TA.states[1]->next['c'].front().guard.push_back(TimedAutomaton::X(1) > 0);
+  const ClockReduction result = reduceClocks(TA);
+
+  BOOST_CHECK_EQUAL(result.before, 4);
+  BOOST_CHECK_EQUAL(result.after, 4);
+  BOOST_CHECK(TA.states[0]->next['a'].front().resetVars == std::vector<ClockVariables>({0, 1, 2}));
+}
+
+BOOST_FIXTURE_TEST_CASE( deadClocksTest, TAFixture )
+{
+  // x3 is read only at the initial state, where x0 is not live yet
+  TA.states[1]->next['c'].front().guard.pop_back();
+  const ClockReduction result = reduceClocks(TA);
+
+  BOOST_CHECK_EQUAL(result.before, 4);
+  BOOST_CHECK_EQUAL(result.after, 1);
+  BOOST_REQUIRE_EQUAL(TA.clockSize(), 1);
+  BOOST_CHECK_EQUAL(TA.maxConstraints[0], 5);
+
+  const auto &a = TA.states[0]->next['a'].front();
+  BOOST_CHECK(a.resetVars == std::vector<ClockVariables>{0});
+  BOOST_CHECK_EQUAL(a.guard.front().x, 0);
+  const auto &c = TA.states[1]->next['c'].front();
+  BOOST_CHECK_EQUAL(c.guard.front().x, 0);
+}
+
+BOOST_AUTO_TEST_CASE( liveThroughResetTest )
+{
+  // x0 and x1 are never live at the same state, but x1 is reset while x0 is live at the target
+  TimedAutomaton TA;
+  TA.states.resize(4);
+  for (auto &state: TA.states) {
+    state = std::make_shared<TAState>();
+  }
+  TA.initialStates = {TA.states[0], TA.states[3]};
+  TA.states[2]->isMatch = true;
+  TA.states[0]->next['a'].push_back({TA.states[1].get(), {1}, {}});
+  TA.states[1]->next['b'].push_back({TA.states[2].get(), {}, {{TimedAutomaton::X(0) < 1}}});
+  TA.states[3]->next['c'].push_back({TA.states[2].get(), {}, {{TimedAutomaton::X(1) > 2}}});
+  TA.maxConstraints = {1, 2};
+
+  const ClockReduction result = reduceClocks(TA);
+
+  BOOST_CHECK_EQUAL(result.before, 2);
+  BOOST_CHECK_EQUAL(result.after, 2);
+  BOOST_CHECK(TA.states[0]->next['a'].front().resetVars == std::vector<ClockVariables>{1});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/monaa.hh"
+
+BOOST_AUTO_TEST_SUITE(compiledPatternTests)
+
+class TAFixture {
+public:
+  TimedAutomaton TA;
+  const std::filesystem::path patternPath =
+      std::filesystem::temp_directory_path().append("monaa_compiled_pattern_test.mpat");
+  TAFixture() {
+    TA.states.resize(4);
+    for (auto &state: TA.states) {
+      state = std::make_shared<TAState>();
+    }
+
+    TA.initialStates = {TA.states[0]};
+
+    TA.states[0]->isMatch = false;
+    TA.states[1]->isMatch = false;
+    TA.states[2]->isMatch = false;
+    TA.states[3]->isMatch = true;
+
+    // Transitions
+    TA.states[0]->next['a'].push_back({TA.states[1].get(), {0}, {}});
+    TA.states[1]->next['b'].push_back({TA.states[2].get(), {}, {{TimedAutomaton::X(0) < 1}}});
+    TA.states[2]->next['a'].push_back({TA.states[3].get(), {}, {}});
+
+    TA.maxConstraints = {1};
+  }
+  ~TAFixture() {
+    std::filesystem::remove(patternPath);
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE( saveLoadTest, TAFixture )
+{
+  const CompiledPattern pattern(TA, CompiledPattern::Mode::signal);
+  saveCompiledPattern(pattern, patternPath.string());
+  const auto loaded = loadCompiledPattern(patternPath.string());
+
+  BOOST_CHECK(loaded->mode == CompiledPattern::Mode::signal);
+  BOOST_REQUIRE_EQUAL(loaded->automaton.stateSize(), pattern.automaton.stateSize());
+  BOOST_CHECK_EQUAL(loaded->automaton.initialStates.size(), 1);
+  BOOST_CHECK_EQUAL(loaded->automaton.initialStates.front(), loaded->automaton.states[0]);
+  BOOST_CHECK_EQUAL(loaded->automaton.clockSize(), 1);
+  for (std::size_t i = 0; i < pattern.automaton.stateSize(); ++i) {
+    BOOST_CHECK_EQUAL(loaded->automaton.states[i]->isMatch, pattern.automaton.states[i]->isMatch);
+    BOOST_CHECK_EQUAL(loaded->beta[loaded->automaton.states[i]], pattern.beta[pattern.automaton.states[i]]);
+  }
+  const auto &edges = loaded->automaton.states[1]->next.at('b');
+  BOOST_REQUIRE_EQUAL(edges.size(), 1);
+  BOOST_CHECK_EQUAL(edges.front().target, loaded->automaton.states[2].get());
+  BOOST_REQUIRE_EQUAL(edges.front().guard.size(), 1);
+  BOOST_CHECK_EQUAL(edges.front().guard.front().c, 1);
+  BOOST_CHECK(edges.front().guard.front().odr == Constraint::Order::lt);
+
+  BOOST_CHECK_EQUAL(loaded->delta.getM(), pattern.delta.getM());
+  // A checkpoint of a monitor of the pattern can be restored with the loaded pattern
+  BOOST_CHECK_EQUAL(fingerprint(*loaded), fingerprint(pattern));
+  BOOST_CHECK(loaded->delta.getDelta() == pattern.delta.getDelta());
+  BOOST_CHECK(loaded->delta.getEndCharMask() == pattern.delta.getEndCharMask());
+  BOOST_CHECK_EQUAL(loaded->delta.useQGram(), pattern.delta.useQGram());
+  BOOST_CHECK_EQUAL(loaded->duration.getMin(), pattern.duration.getMin());
+  BOOST_CHECK_EQUAL(loaded->duration.getMax(), pattern.duration.getMax());
+
+  // The matching with the loaded pattern gives the same result
+  std::filesystem::path inputPath = std::filesystem::path{PROJECT_ROOT_DIR}.append("test").append("timed_word.txt");
+  FILE* file(fopen(inputPath.c_str(), "r"));
+  WordVector<std::pair<Alphabet,double> > w(file, false);
+  AnsVec<Zone> ans;
+  monaa(w, *loaded, ans);
+  BOOST_CHECK_EQUAL(ans.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( invalidFileTest )
+{
+  std::filesystem::path inputPath = std::filesystem::path{PROJECT_ROOT_DIR}.append("test").append("timed_word.txt");
+  BOOST_CHECK_THROW(loadCompiledPattern(inputPath.string()), std::runtime_error);
+}
+
+BOOST_FIXTURE_TEST_CASE( corruptFileTest, TAFixture )
+{
+  const CompiledPattern pattern(TA, CompiledPattern::Mode::signal);
+  saveCompiledPattern(pattern, patternPath.string());
+  BOOST_REQUIRE_EQUAL(pattern.automaton.clockSize(), 1);
+  BOOST_REQUIRE_EQUAL(pattern.automaton.stateSize(), 4);
+  std::vector<char> original(std::filesystem::file_size(patternPath));
+  std::ifstream(patternPath, std::ios::binary).read(original.data(), original.size());
+
+  // The offsets in the file: the header, the maximum constraints, the flags of the states, the initial state, and
+  // the transitions of the states 0, 1, and 2
+  const std::size_t firstTransition = 48 + 4 + 4 + 8;
+  const std::size_t resetOffset = firstTransition + 28;
+  const std::size_t guardOffset = firstTransition + 32 + 28;
+  const std::size_t sundayOffset = firstTransition + 32 + 40 + 28;
+  const std::size_t deltaOffset = sundayOffset + 4 + 4 + 8;
+  const std::size_t qGramSizeOffset = deltaOffset + 4 * (UCHAR_MAX + 1) + 32;
+  // The KMP-type skip values of the 4 states followed by the bounds of the duration
+  const std::size_t betaOffset = original.size() - 16 - 4 * 4;
+  const auto readAt = [&](std::size_t offset) {
+    std::uint32_t value;
+    std::memcpy(&value, original.data() + offset, sizeof(value));
+    return value;
+  };
+  BOOST_REQUIRE_EQUAL(readAt(resetOffset), 0);
+  BOOST_REQUIRE_EQUAL(readAt(guardOffset + 8), 1);
+  BOOST_REQUIRE_EQUAL(readAt(sundayOffset), pattern.delta.getM());
+  BOOST_REQUIRE_EQUAL(readAt(deltaOffset), pattern.delta[0]);
+  BOOST_REQUIRE_EQUAL(readAt(betaOffset), pattern.beta[pattern.automaton.states[0]]);
+
+  const auto loadWith = [&](std::size_t offset, auto value) {
+    std::vector<char> bytes = original;
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+    std::ofstream(patternPath, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+    return loadCompiledPattern(patternPath.string());
+  };
+  // The clock variables out of range
+  BOOST_CHECK_THROW(loadWith(resetOffset, std::uint32_t(1)), std::runtime_error);
+  BOOST_CHECK_THROW(loadWith(guardOffset, std::uint32_t(1)), std::runtime_error);
+  // The unknown order of a constraint
+  BOOST_CHECK_THROW(loadWith(guardOffset + 4, std::int32_t(4)), std::runtime_error);
+  BOOST_CHECK_THROW(loadWith(guardOffset + 4, std::int32_t(-1)), std::runtime_error);
+  // The skip values making no progress
+  BOOST_CHECK_THROW(loadWith(sundayOffset, std::int32_t(0)), std::runtime_error);
+  BOOST_CHECK_THROW(loadWith(deltaOffset, std::uint32_t(0)), std::runtime_error);
+  // The skip values skipping a matching, and the end characters inconsistent with them
+  BOOST_REQUIRE(!pattern.delta.isEndChar(0));
+  BOOST_CHECK_THROW(loadWith(deltaOffset, std::uint32_t(pattern.delta.getM() + 2)), std::runtime_error);
+  BOOST_CHECK_THROW(loadWith(deltaOffset, std::uint32_t(1)), std::runtime_error);
+  BOOST_CHECK_THROW(loadWith(deltaOffset + 4 * (UCHAR_MAX + 1), std::uint64_t(1)), std::runtime_error);
+  if (pattern.delta.useQGram()) {
+    BOOST_CHECK_THROW(loadWith(qGramSizeOffset + 8, std::uint32_t(pattern.delta.getM() + 3)), std::runtime_error);
+    BOOST_CHECK_THROW(loadWith(qGramSizeOffset + 8, std::uint32_t(1)), std::runtime_error);
+  }
+  // The size of the q-gram table is checked before the allocation
+  BOOST_CHECK_THROW(loadWith(qGramSizeOffset, std::uint64_t(1) << 62), std::runtime_error);
+  BOOST_CHECK_THROW(loadWith(qGramSizeOffset, std::uint64_t(3)), std::runtime_error);
+  // The KMP-type skip values making no progress or skipping a matching
+  BOOST_CHECK_THROW(loadWith(betaOffset, std::int32_t(0)), std::runtime_error);
+  BOOST_CHECK_THROW(loadWith(betaOffset, std::int32_t(pattern.delta.getM() + 2)), std::runtime_error);
+  // The bytes after the last section
+  {
+    std::vector<char> bytes = original;
+    bytes.push_back(0);
+    std::ofstream(patternPath, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+    BOOST_CHECK_THROW(loadCompiledPattern(patternPath.string()), std::runtime_error);
+  }
+  // The original one is still valid
+  BOOST_CHECK_NO_THROW(loadWith(sundayOffset, std::int32_t(pattern.delta.getM())));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,117 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/timed_automaton.hh"
+#include "../libmonaa/indexed_timed_automaton.hh"
+
+BOOST_AUTO_TEST_SUITE(indexedTimedAutomatonTests)
+
+class TAFixture {
+public:
+  TimedAutomaton TA;
+  TAFixture() {
+    TA.states.resize(3);
+    for (auto &state: TA.states) {
+      state = std::make_shared<TAState>();
+    }
+
+    TA.initialStates = {TA.states[0]};
+
+    TA.states[0]->isMatch = false;
+    TA.states[1]->isMatch = false;
+    TA.states[2]->isMatch = true;
+    TA.states[1]->zeroDuration = true;
+
+    // Transitions
+    TA.states[0]->next['a'].push_back({TA.states[1].get(), {0}, {}});
+    TA.states[0]->next['a'].push_back({nullptr, {}, {}});
+    TA.states[1]->next['b'].push_back({TA.states[1].get(), {}, {{TimedAutomaton::X(0) < 1}}});
+    TA.states[1]->next['$'].push_back({TA.states[2].get(), {0}, {{TimedAutomaton::X(0) > 0}, {TimedAutomaton::X(0) <= 2}}});
+
+    TA.maxConstraints = {2};
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE( roundTripTest, TAFixture )
+{
+  const IndexedTimedAutomaton indexed(TA);
+  BOOST_CHECK_EQUAL(indexed.stateSize(), 3);
+  BOOST_CHECK_EQUAL(indexed.transitions.size(), 4);
+  BOOST_CHECK_EQUAL(indexed.transitionBegin.size(), 4);
+  BOOST_CHECK_EQUAL(indexed.guards.size(), 3);
+
+  // A copy is independent of the original
+  IndexedTimedAutomaton copied = indexed;
+  copied.states[2].isMatch = false;
+  BOOST_TEST(indexed.states[2].isMatch);
+
+  TimedAutomaton result;
+  indexed.toTimedAutomaton(result);
+  BOOST_REQUIRE_EQUAL(result.stateSize(), 3);
+  BOOST_REQUIRE_EQUAL(result.initialStates.size(), 1);
+  BOOST_CHECK_EQUAL(result.initialStates.front(), result.states[0]);
+  BOOST_TEST(result.states[1]->zeroDuration);
+  BOOST_TEST(result.states[2]->isMatch);
+  BOOST_CHECK_EQUAL(result.clockSize(), 1);
+  for (std::size_t i = 0; i < TA.stateSize(); ++i) {
+    BOOST_CHECK_EQUAL(result.states[i]->next.size(), TA.states[i]->next.size());
+  }
+  const auto &a = result.states[0]->next.at('a');
+  BOOST_REQUIRE_EQUAL(a.size(), 2);
+  BOOST_CHECK_EQUAL(a[0].target, result.states[1].get());
+  BOOST_TEST(a[0].resetVars == std::vector<ClockVariables>{0});
+  BOOST_CHECK(a[1].target == nullptr);
+  const auto &dollar = result.states[1]->next.at('$');
+  BOOST_REQUIRE_EQUAL(dollar.size(), 1);
+  BOOST_CHECK_EQUAL(dollar.front().target, result.states[2].get());
+  BOOST_REQUIRE_EQUAL(dollar.front().guard.size(), 2);
+  BOOST_CHECK(dollar.front().guard[1].odr == Constraint::Order::le);
+  BOOST_CHECK_EQUAL(dollar.front().guard[1].c, 2);
+}
+
+BOOST_FIXTURE_TEST_CASE( eraseTransitionsTest, TAFixture )
+{
+  IndexedTimedAutomaton indexed(TA);
+  indexed.eraseTransitions([](std::size_t, const IndexedTimedAutomaton::Transition &transition) {
+    return transition.c == 'a';
+  });
+  BOOST_CHECK_EQUAL(indexed.transitions.size(), 2);
+  BOOST_CHECK_EQUAL(indexed.transitionBegin[1], 0);
+  BOOST_CHECK_EQUAL(indexed.transitionBegin[2], 2);
+  BOOST_CHECK_EQUAL(indexed.transitionBegin[3], 2);
+
+  TimedAutomaton result;
+  indexed.toTimedAutomaton(result);
+  BOOST_TEST(result.states[0]->next.empty());
+  BOOST_CHECK_EQUAL(result.states[1]->next.size(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE( appendTest, TAFixture )
+{
+  IndexedTimedAutomaton indexed(TA);
+  IndexedTimedAutomaton other(TA);
+  other.maxConstraints = {1, 5};
+  indexed.append(other);
+  BOOST_CHECK_EQUAL(indexed.stateSize(), 6);
+  BOOST_CHECK_EQUAL(indexed.transitions.size(), 8);
+  BOOST_CHECK_EQUAL(indexed.transitionBegin.size(), 7);
+  BOOST_TEST(indexed.maxConstraints == std::vector<int>({2, 5}));
+
+  TimedAutomaton result;
+  indexed.toTimedAutomaton(result);
+  BOOST_REQUIRE_EQUAL(result.initialStates.size(), 2);
+  BOOST_CHECK_EQUAL(result.initialStates[1], result.states[3]);
+  BOOST_TEST(result.states[4]->zeroDuration);
+  BOOST_TEST(result.states[5]->isMatch);
+  const auto &a = result.states[3]->next.at('a');
+  BOOST_REQUIRE_EQUAL(a.size(), 2);
+  BOOST_CHECK_EQUAL(a[0].target, result.states[4].get());
+  BOOST_CHECK(a[1].target == nullptr);
+  const auto &dollar = result.states[4]->next.at('$');
+  BOOST_REQUIRE_EQUAL(dollar.size(), 1);
+  BOOST_CHECK_EQUAL(dollar.front().target, result.states[5].get());
+  BOOST_TEST(dollar.front().resetVars == std::vector<ClockVariables>{0});
+  BOOST_REQUIRE_EQUAL(dollar.front().guard.size(), 2);
+  BOOST_CHECK_EQUAL(dollar.front().guard[1].c, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -243,6 +243,15 @@ BOOST_FIXTURE_TEST_CASE(isMemberUnTimedPlusComplexMulti, ConstructTA)
   BOOST_TEST(TA.isMember({{'c', 2.9}, {'b', 2.9}, {'a', 2.9}}));
 }
 
+BOOST_FIXTURE_TEST_CASE(isMemberUnTimedPlusConcat, ConstructTA)
+{
+  constructSignalTA("(ab)+");
+
+  BOOST_TEST(TA.isMember({{'a', 1.0}, {'b', 2.0}}));
+  BOOST_TEST(TA.isMember({{'a', 1.0}, {'b', 2.0}, {'a', 3.0}, {'b', 4.0}}));
+  BOOST_TEST(!TA.isMember({{'a', 1.0}, {'b', 2.0}, {'a', 3.0}}));
+}
+
 BOOST_FIXTURE_TEST_CASE(isMemberConcatIntervals, ConstructTA)
 {
   constructSignalTA("a(a%(1,2))a(a%(2,3))");
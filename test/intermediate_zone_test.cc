@@ -175,6 +175,63 @@ BOOST_AUTO_TEST_CASE(intervalToZoneTest) {
   BOOST_TEST(bool(in.value(3, 3) == Bounds(0, true)));
 }
 
+BOOST_AUTO_TEST_CASE(zoneToIntervalTest) {
+  IntermediateZone in = {Interval{{4.7, true}, {5.3, false}}};
+  BOOST_CHECK_EQUAL(in.alloc({5.8, true}, {-5.3, false}), 2);
+  BOOST_CHECK_EQUAL(in.alloc({6.3, true}, {-5.8, false}), 3);
+  BOOST_TEST(!in.useInterval);
+  const Zone zone = in;
+
+  // The variable 2 is not referred to and we go back to the intervals
+  std::vector<boost::variant<double, ClockVariables>> resetTime = {ClockVariables(1), double(5.3)};
+  in.update(resetTime);
+  BOOST_TEST(in.useInterval);
+  BOOST_CHECK_EQUAL(in.intervals.size(), 3);
+  BOOST_CHECK_EQUAL(in.newestClock, 2);
+  BOOST_TEST(bool(in.intervals[0].lowerBound == zone.value(0, 1)));
+  BOOST_TEST(bool(in.intervals[0].upperBound == zone.value(1, 0)));
+  BOOST_TEST(bool(in.intervals[1].lowerBound == zone.value(0, 3)));
+  BOOST_TEST(bool(in.intervals[1].upperBound == zone.value(3, 0)));
+  BOOST_TEST(bool(in.intervals[2].lowerBound == zone.value(1, 3)));
+  BOOST_TEST(bool(in.intervals[2].upperBound == zone.value(3, 1)));
+  BOOST_TEST(in.isSatisfiableCanonized());
+
+  // The answer is the same as the one by the zone
+  Zone fromInterval, fromZone;
+  in.toAns(fromInterval);
+  IntermediateZone{zone, 3}.toAns(fromZone);
+  BOOST_TEST(bool(fromInterval == fromZone));
+}
+
+BOOST_AUTO_TEST_CASE(zoneNotToIntervalTest) {
+  IntermediateZone in = {Interval{{4.7, true}, {5.3, false}}};
+  in.alloc({5.8, true}, {-5.3, false});
+  in.alloc({6.3, true}, {-5.8, false});
+
+  // The variable 2 is still referred to
+  std::vector<boost::variant<double, ClockVariables>> resetTime = {ClockVariables(2)};
+  in.update(resetTime);
+  BOOST_TEST(!in.useInterval);
+  BOOST_CHECK_EQUAL(in.newestClock, 3);
+}
+
+BOOST_AUTO_TEST_CASE(zoneToIntervalRenameTest) {
+  IntermediateZone in = {Interval{{4.7, true}, {5.3, false}}};
+  in.alloc({5.8, true}, {-5.3, false});
+  in.alloc({6.3, true}, {-5.8, false});
+  const Zone zone = in;
+
+  // Only the newest variable is referred to, and it is renamed to 2
+  std::vector<boost::variant<double, ClockVariables>> resetTime = {ClockVariables(3), ClockVariables(1)};
+  in.update(resetTime);
+  BOOST_TEST(in.useInterval);
+  BOOST_CHECK_EQUAL(in.newestClock, 2);
+  BOOST_CHECK_EQUAL(boost::get<ClockVariables>(resetTime[0]), 2);
+  BOOST_CHECK_EQUAL(boost::get<ClockVariables>(resetTime[1]), 1);
+  BOOST_TEST(bool(in.intervals[1].lowerBound == zone.value(0, 3)));
+  BOOST_TEST(bool(in.intervals[1].upperBound == zone.value(3, 0)));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
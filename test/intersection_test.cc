@@ -64,4 +64,29 @@ BOOST_FIXTURE_TEST_CASE( updateInitAcceptingTest, IntersectionFixture)
       }), 2);
 }
 
+BOOST_FIXTURE_TEST_CASE( reachableIntersectionTest, IntersectionFixture )
+{
+  TimedAutomaton reachableOut;
+  boost::unordered_map<std::pair<TAState*, TAState*>, std::shared_ptr<TAState>> reachableToIState;
+  reachableIntersectionTA(TAs[0], TAs[1], reachableOut, reachableToIState);
+
+  // Expected Results
+  auto initState = reachableToIState[std::make_pair(TAs[0].states[0].get(), TAs[1].states[0].get())];
+  auto acceptState = reachableToIState[std::make_pair(TAs[0].states[1].get(), TAs[1].states[1].get())];
+
+  // Comparison
+  BOOST_TEST (out.states.size() == 4);
+  BOOST_TEST (reachableOut.states.size() == 2);
+  BOOST_TEST (reachableOut.maxConstraints == out.maxConstraints);
+  BOOST_TEST (reachableOut.initialStates.size() == 1);
+  BOOST_REQUIRE_EQUAL (reachableOut.initialStates[0], initState);
+  BOOST_CHECK_EQUAL (initState->next[0].size(), 1);
+  BOOST_CHECK_EQUAL (initState->next['a'].size(), 1);
+  BOOST_TEST (initState->next[0].front().target == initState.get());
+  BOOST_TEST (initState->next['a'].front().target == acceptState.get());
+  BOOST_TEST (initState->next['a'].front().guard.size() == 2);
+  BOOST_TEST (initState->next['a'].front().guard.back().x == 1);
+  BOOST_TEST (acceptState->isMatch == true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
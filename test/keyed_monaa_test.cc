@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <unordered_map>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/ans_vec.hh"
+#include "../libmonaa/keyed_monaa.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(keyedMonaaTest)
+
+BOOST_AUTO_TEST_CASE(sameAsEachKey) {
+  // Pseudo random timed words over {a, b, c} of three keys interleaved in one log
+  const std::vector<std::string> keys = {"car1", "car2", "car3"};
+  std::vector<std::vector<std::pair<Alphabet, double>>> words(keys.size());
+  FILE *file = std::tmpfile();
+  BOOST_REQUIRE(file);
+  RandomTimedWord generator;
+  for (int i = 0; i < 3000; ++i) {
+    const auto event = generator.next();
+    const std::size_t k = (generator.state() >> 4) % keys.size();
+    words[k].push_back(event);
+    fprintf(file, "%s %c %.17g\n", keys[k].c_str(), words[k].back().first, words[k].back().second);
+  }
+  std::rewind(file);
+
+  TimedAutomaton TA;
+  makeReferenceTA(TA, '$', 3, 4);
+  const auto pattern = std::make_shared<const CompiledPattern>(TA, CompiledPattern::Mode::event);
+
+  for (const std::size_t threadSize : {1, 2}) {
+    std::rewind(file);
+    std::unordered_map<std::string, AnsVec<Zone>> result;
+    KeyedMonitor monitor(pattern, [&](const std::string &key, const Zone &zone) { result[key].push_back(zone); },
+                         threadSize, 16);
+    BOOST_CHECK_EQUAL(keyedMonaa(file, monitor), 3000);
+    BOOST_CHECK_EQUAL(monitor.keySize(), keys.size());
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+      AnsVec<Zone> expected;
+      monaaDollar(WordSlice<std::pair<Alphabet, double>>(words[k].data(), words[k].size()), *pattern, expected);
+      BOOST_TEST(expected.size() > 0);
+      BOOST_REQUIRE_EQUAL(result[keys[k]].size(), expected.size());
+      auto it = expected.begin();
+      for (const Zone &zone : result[keys[k]]) {
+        BOOST_TEST(bool(zone == *it++));
+      }
+    }
+  }
+  std::fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(longKey) {
+  // A key longer than any fixed buffer must not be truncated nor split into the other columns
+  const std::string key(1000, 'k');
+  FILE *file = std::tmpfile();
+  BOOST_REQUIRE(file);
+  fprintf(file, "%s a 0.5\nshort b 1.5\n", key.c_str());
+  std::rewind(file);
+  std::string readKey;
+  std::pair<Alphabet, double> elem;
+  BOOST_REQUIRE_EQUAL(getOneKeyed(file, readKey, elem), 3);
+  BOOST_CHECK(readKey == key);
+  BOOST_CHECK_EQUAL(elem.first, 'a');
+  BOOST_CHECK_EQUAL(elem.second, 0.5);
+  BOOST_REQUIRE_EQUAL(getOneKeyed(file, readKey, elem), 3);
+  BOOST_CHECK_EQUAL(readKey, "short");
+  BOOST_CHECK_EQUAL(elem.first, 'b');
+  BOOST_CHECK_EQUAL(elem.second, 1.5);
+  BOOST_CHECK_EQUAL(getOneKeyed(file, readKey, elem), EOF);
+  std::fclose(file);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
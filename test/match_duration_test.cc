@@ -0,0 +1,50 @@
+#include <boost/test/unit_test.hpp>
+#include <limits>
+
+#include "../libmonaa/timed_automaton.hh"
+#include "../libmonaa/match_duration.hh"
+
+BOOST_AUTO_TEST_SUITE(matchDurationTests)
+
+class TAFixture {
+public:
+  TimedAutomaton TA;
+  TAFixture() {
+    TA.states.resize(3);
+    for (auto &state: TA.states) {
+      state = std::make_shared<TAState>();
+    }
+
+    TA.initialStates = {TA.states[0]};
+
+    TA.states[0]->isMatch = false;
+    TA.states[1]->isMatch = false;
+    TA.states[2]->isMatch = true;
+
+    // Transitions
+    TA.states[0]->next['a'].push_back({TA.states[1].get(), {1}, {{TimedAutomaton::X(0) > 1}}});
+    TA.states[1]->next['b'].push_back({TA.states[1].get(), {}, {{TimedAutomaton::X(1) < 1}}});
+    TA.states[1]->next['$'].push_back({TA.states[2].get(), {}, {{TimedAutomaton::X(0) <= 3}}});
+
+    TA.maxConstraints = {3, 1};
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE( boundedTest, TAFixture )
+{
+  MatchDuration duration(TA);
+
+  BOOST_CHECK_EQUAL(duration.getMin(), 1);
+  BOOST_CHECK_EQUAL(duration.getMax(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE( unboundedTest, TAFixture )
+{
+  TA.states[1]->next['$'].front().guard.clear();
+  MatchDuration duration(TA);
+
+  BOOST_CHECK_EQUAL(duration.getMin(), 1);
+  BOOST_CHECK_EQUAL(duration.getMax(), std::numeric_limits<double>::infinity());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,45 @@
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/monaa.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(matchStatsTest)
+
+BOOST_AUTO_TEST_CASE(counters) {
+  const auto word = makeRandomTimedWord();
+  TimedAutomaton TA;
+  makeReferenceTA(TA, '$');
+  const CompiledPattern pattern(TA, CompiledPattern::Mode::event);
+  BOOST_TEST(pattern.delta.getConstructionTime() >= pattern.delta.getTa2zaTime());
+  BOOST_TEST(pattern.beta.getConstructionTime() >= pattern.beta.getTa2zaTime());
+
+  AnsVec<Zone> expected;
+  monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, expected);
+  AnsVec<Zone> result;
+  MatchCounters counters;
+  monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, result, &counters);
+  BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+
+  BOOST_CHECK_EQUAL(counters.events, word.size());
+  BOOST_TEST(counters.sundayShifts > 0);
+  BOOST_TEST(counters.kmpShifts > 0);
+  // The shifts do not go far beyond the end of the timed word
+  BOOST_TEST(counters.sundayShiftLength + counters.kmpShiftLength <= word.size() + pattern.delta.getM());
+  BOOST_TEST(counters.configurations >= expected.size());
+  BOOST_CHECK_EQUAL(counters.peakConfigurations, 1);
+  BOOST_CHECK_EQUAL(counters.peakWindow, 3);
+
+  MatchStats stats;
+  stats.events = counters.events;
+  stats.zones = result.size();
+  stats.counters = counters;
+  stats.clocks = pattern.clocks;
+  std::stringstream json;
+  stats.printJSON(json);
+  BOOST_TEST(json.str().find("\"bytes\": null") != std::string::npos);
+  BOOST_TEST(json.str().find("\"events\": 3000") != std::string::npos);
+  BOOST_TEST(json.str().find("\"clocks_after\": " + std::to_string(pattern.clocks.after)) != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
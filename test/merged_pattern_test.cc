@@ -0,0 +1,69 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/monaa.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(mergedPatternTests)
+
+struct MergedPatternFixture {
+  std::vector<std::pair<Alphabet, double>> word = makeRandomTimedWord(1000);
+  // a b $ with the duration less than 3
+  TimedAutomaton ab;
+  // c a $ with the duration less than 1
+  TimedAutomaton ca;
+
+  static void makeTA(TimedAutomaton &TA, Alphabet first, Alphabet second, int bound) {
+    TA.states.resize(4);
+    for (auto &state : TA.states) {
+      state = std::make_shared<TAState>();
+    }
+    TA.initialStates = {TA.states[0]};
+    TA.states[3]->isMatch = true;
+    TA.states[0]->next[first].push_back({TA.states[1].get(), {}, {}});
+    TA.states[1]->next[second].push_back({TA.states[2].get(), {}, {}});
+    TA.states[2]->next['$'].push_back({TA.states[3].get(), {}, {TimedAutomaton::X(0) < bound}});
+    TA.maxConstraints = {bound};
+  }
+
+  MergedPatternFixture() {
+    makeTA(ab, 'a', 'b', 3);
+    makeTA(ca, 'c', 'a', 1);
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(tags, MergedPatternFixture) {
+  const MergedPattern merged({&ab, &ca}, CompiledPattern::Mode::event);
+  BOOST_CHECK_EQUAL(merged.patternSize, 2);
+  BOOST_CHECK_EQUAL(merged.pattern.automaton.stateSize(), 8);
+  BOOST_CHECK_EQUAL(merged.pattern.automaton.initialStates.size(), 2);
+  BOOST_CHECK_EQUAL(merged.pattern.automaton.clockSize(), 1);
+  BOOST_REQUIRE_EQUAL(merged.tags.size(), 2);
+  BOOST_CHECK_EQUAL(merged.tags.at(merged.pattern.automaton.states[3].get()), 0);
+  BOOST_CHECK_EQUAL(merged.tags.at(merged.pattern.automaton.states[7].get()), 1);
+  // The skip values are safe for both patterns.
+  BOOST_CHECK_EQUAL(merged.pattern.delta.getM(), 2);
+  BOOST_CHECK_EQUAL(merged.pattern.delta['a'], 1);
+  BOOST_CHECK_EQUAL(merged.pattern.delta['c'], 2);
+  BOOST_CHECK_EQUAL(merged.pattern.duration.getMax(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(sameAsEachPattern, MergedPatternFixture) {
+  const MergedPattern merged({&ab, &ca}, CompiledPattern::Mode::event);
+  std::vector<AnsVec<Zone>> result(2);
+  monaaMerged(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), merged, result);
+
+  for (const TimedAutomaton *TA : {&ab, &ca}) {
+    const std::size_t k = TA == &ab ? 0 : 1;
+    AnsVec<Zone> expected;
+    monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()),
+                CompiledPattern(*TA, CompiledPattern::Mode::event), expected);
+    BOOST_TEST(expected.size() > 0);
+    BOOST_REQUIRE_EQUAL(result[k].size(), expected.size());
+    auto it = expected.begin();
+    for (const Zone &zone : result[k]) {
+      BOOST_TEST(bool(zone == *it++));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,170 @@
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/monaa.hh"
+#include "../libmonaa/monaa_c.h"
+#include "../libmonaa/state_minimization.hh"
+#include "../monaa/timed_automaton_parser.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(monaaCTest)
+
+namespace {
+  const char *dot = "digraph G {\n"
+                    "  1 [init=1][match=0]\n"
+                    "  2 [init=0][match=0]\n"
+                    "  3 [init=0][match=0]\n"
+                    "  4 [init=0][match=1]\n"
+                    "  1->2 [label=a][reset=\"{0}\"][guard=\"{x0 < 1}\"];\n"
+                    "  2->2 [label=b][guard=\"{x0 < 3}\"];\n"
+                    "  2->3 [label=c][guard=\"{x0 < 3}\"];\n"
+                    "  3->4 [label=\"$\"][guard=\"{x0 < 4}\"];\n"
+                    "}\n";
+}
+
+BOOST_AUTO_TEST_CASE(sameAsMonaaDollar) {
+  // The pseudo random timed word in columns
+  const auto word = makeRandomTimedWord();
+  std::vector<char> events;
+  std::vector<double> timestamps;
+  for (const auto &[c, t] : word) {
+    events.push_back(c);
+    timestamps.push_back(t);
+  }
+
+  std::stringstream taStream(dot);
+  BoostTimedAutomaton BoostTA;
+  parseBoostTA(taStream, BoostTA);
+  TimedAutomaton TA;
+  convBoostTA(BoostTA, TA);
+  minimizeStates(TA);
+  AnsVec<Zone> expected;
+  monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()),
+              CompiledPattern(TA, CompiledPattern::Mode::event), expected);
+  BOOST_TEST(expected.size() > 0);
+
+  monaa_pattern *pattern = monaa_pattern_compile_dot(dot);
+  BOOST_REQUIRE(pattern);
+  monaa_matcher *matcher = monaa_matcher_new(pattern);
+  BOOST_REQUIRE(matcher);
+  monaa_pattern_free(pattern);
+
+  std::vector<monaa_match> result;
+  std::vector<monaa_match> buffer(7);
+  for (std::size_t i = 0; i < events.size(); i += 1000) {
+    BOOST_CHECK_EQUAL(monaa_matcher_feed(matcher, events.data() + i, timestamps.data() + i, 1000), 0);
+    while (std::size_t size = monaa_matcher_drain(matcher, buffer.data(), buffer.size())) {
+      result.insert(result.end(), buffer.begin(), buffer.begin() + size);
+    }
+  }
+  BOOST_CHECK_EQUAL(monaa_matcher_finish(matcher), 0);
+  BOOST_CHECK_EQUAL(monaa_matcher_pending(matcher), expected.size() - result.size());
+  while (std::size_t size = monaa_matcher_drain(matcher, buffer.data(), buffer.size())) {
+    result.insert(result.end(), buffer.begin(), buffer.begin() + size);
+  }
+  monaa_matcher_free(matcher);
+
+  BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+  auto it = result.begin();
+  for (const Zone &zone : expected) {
+    BOOST_CHECK_EQUAL(it->begin.lower, -zone.value(0, 1).first);
+    BOOST_CHECK_EQUAL(it->begin.upper, zone.value(1, 0).first);
+    BOOST_CHECK_EQUAL(it->end.lower, -zone.value(0, 2).first);
+    BOOST_CHECK_EQUAL(it->end.upper, zone.value(2, 0).first);
+    BOOST_CHECK_EQUAL(it->duration.lower_closed, zone.value(1, 2).second);
+    BOOST_CHECK_EQUAL(it->duration.upper, zone.value(2, 1).first);
+    ++it;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch) {
+  const char events[] = {'a', 'b', 'c', 'a', 'c', 'a'};
+  const double timestamps[] = {0.5, 1.0, 1.5, 2.0, 2.5, 3.0};
+  monaa_pattern *pattern = monaa_pattern_compile_dot(dot);
+  BOOST_REQUIRE(pattern);
+
+  monaa_match matches[2];
+  std::size_t found = 0;
+  BOOST_CHECK_EQUAL(monaa_match_batch(pattern, events, timestamps, 6, matches, 1, &found), 0);
+  BOOST_CHECK_EQUAL(found, 2);
+  BOOST_CHECK_EQUAL(monaa_match_batch(pattern, events, timestamps, 6, matches, 2, &found), 0);
+  BOOST_REQUIRE_EQUAL(found, 2);
+  // a b c from [0, 0.5), and a c from [1.5, 2.0)
+  BOOST_CHECK_EQUAL(matches[0].begin.lower, 0);
+  BOOST_CHECK_EQUAL(matches[0].begin.upper, 0.5);
+  BOOST_CHECK_EQUAL(matches[0].end.lower, 1.5);
+  BOOST_CHECK_EQUAL(matches[1].begin.lower, 1.5);
+  BOOST_CHECK_EQUAL(matches[1].end.upper, 3.0);
+  monaa_pattern_free(pattern);
+}
+
+BOOST_AUTO_TEST_CASE(errors) {
+  BOOST_CHECK(!monaa_pattern_compile_dot("digraph G {"));
+  BOOST_CHECK(std::string(monaa_last_error()).size() > 0);
+  BOOST_CHECK(!monaa_pattern_load("/nonexistent/pattern"));
+
+  monaa_pattern *pattern = monaa_pattern_compile_dot(dot);
+  BOOST_REQUIRE(pattern);
+  monaa_matcher *matcher = monaa_matcher_new(pattern);
+  monaa_pattern_free(pattern);
+  BOOST_CHECK_EQUAL(monaa_matcher_finish(matcher), 0);
+  const char event = 'a';
+  const double timestamp = 0.5;
+  BOOST_CHECK_EQUAL(monaa_matcher_feed(matcher, &event, &timestamp, 1), -1);
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "the matcher is already finished");
+  monaa_matcher_free(matcher);
+}
+
+BOOST_AUTO_TEST_CASE(emptyPattern) {
+  // The accepting state is unreachable
+  const char *emptyDot = "digraph G {\n"
+                         "  1 [init=1][match=0]\n"
+                         "  2 [init=0][match=1]\n"
+                         "  1->1 [label=a];\n"
+                         "}\n";
+  BOOST_CHECK(!monaa_pattern_compile_dot(emptyDot));
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "empty pattern");
+}
+
+BOOST_AUTO_TEST_CASE(nullArguments) {
+  BOOST_CHECK(!monaa_pattern_compile_tre(nullptr));
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "expression is NULL");
+  BOOST_CHECK(!monaa_pattern_compile_dot(nullptr));
+  BOOST_CHECK(!monaa_pattern_load(nullptr));
+  BOOST_CHECK(!monaa_matcher_new(nullptr));
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "pattern is NULL");
+
+  const char event = 'a';
+  const double timestamp = 0.5;
+  monaa_match match;
+  std::size_t found = 0;
+  BOOST_CHECK_EQUAL(monaa_matcher_feed(nullptr, &event, &timestamp, 1), -1);
+  BOOST_CHECK_EQUAL(monaa_matcher_finish(nullptr), -1);
+  BOOST_CHECK_EQUAL(monaa_matcher_pending(nullptr), 0);
+  BOOST_CHECK_EQUAL(monaa_matcher_drain(nullptr, &match, 1), 0);
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "matcher is NULL");
+  BOOST_CHECK_EQUAL(monaa_match_batch(nullptr, &event, &timestamp, 1, &match, 1, &found), -1);
+  monaa_pattern_free(nullptr);
+  monaa_matcher_free(nullptr);
+
+  monaa_pattern *pattern = monaa_pattern_compile_dot(dot);
+  BOOST_REQUIRE(pattern);
+  monaa_matcher *matcher = monaa_matcher_new(pattern);
+  BOOST_REQUIRE(matcher);
+  BOOST_CHECK_EQUAL(monaa_matcher_feed(matcher, nullptr, &timestamp, 1), -1);
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "events is NULL");
+  BOOST_CHECK_EQUAL(monaa_matcher_feed(matcher, &event, nullptr, 1), -1);
+  // The arrays of size 0 can be NULL
+  BOOST_CHECK_EQUAL(monaa_matcher_feed(matcher, nullptr, nullptr, 0), 0);
+  BOOST_CHECK_EQUAL(monaa_matcher_drain(matcher, nullptr, 1), 0);
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "matches is NULL");
+  BOOST_CHECK_EQUAL(monaa_match_batch(pattern, &event, &timestamp, 1, nullptr, 1, &found), -1);
+  BOOST_CHECK_EQUAL(monaa_match_batch(pattern, &event, &timestamp, 1, &match, 1, nullptr), -1);
+  BOOST_CHECK_EQUAL(std::string(monaa_last_error()), "found is NULL");
+  BOOST_CHECK_EQUAL(monaa_match_batch(pattern, nullptr, nullptr, 0, nullptr, 0, &found), 0);
+  BOOST_CHECK_EQUAL(found, 0);
+  monaa_matcher_free(matcher);
+  monaa_pattern_free(pattern);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
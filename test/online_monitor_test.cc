@@ -0,0 +1,186 @@
+#include <cstring>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/online_monitor.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(onlineMonitorTest)
+
+namespace {
+  // a b* c $ with timing constraints. If withB is false, a c $. The guard of c is x < cBound.
+  CompiledPattern makePattern(bool withB, int cBound = 3) {
+    TimedAutomaton TA;
+    TA.states.resize(4);
+    for (auto &state : TA.states) {
+      state = std::make_shared<TAState>();
+    }
+    TA.initialStates = {TA.states[0]};
+    TA.states[3]->isMatch = true;
+    TA.states[0]->next['a'].push_back({TA.states[1].get(), {0}, {TimedAutomaton::X(0) < 1}});
+    if (withB) {
+      TA.states[1]->next['b'].push_back({TA.states[1].get(), {}, {TimedAutomaton::X(0) < 3}});
+    }
+    TA.states[1]->next['c'].push_back({TA.states[2].get(), {}, {TimedAutomaton::X(0) < cBound}});
+    TA.states[2]->next['$'].push_back({TA.states[3].get(), {}, {TimedAutomaton::X(0) < 4}});
+    TA.maxConstraints = {4};
+    return CompiledPattern(TA, CompiledPattern::Mode::event);
+  }
+
+  void checkSame(const std::vector<Zone> &result, AnsVec<Zone> &expected) {
+    BOOST_TEST(expected.size() > 0);
+    BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+    auto it = expected.begin();
+    for (const Zone &zone : result) {
+      BOOST_TEST(bool(zone == *it++));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(feedOneByOne) {
+  const auto word = makeRandomTimedWord();
+  for (const bool withB : {false, true}) {
+    const CompiledPattern pattern = makePattern(withB);
+    AnsVec<Zone> expected;
+    monaaDollar(WordSlice<OnlineMonitor::Event>(word.data(), word.size()), pattern, expected);
+
+    std::vector<Zone> result;
+    OnlineMonitor monitor(pattern, [&result](const Zone &zone) { result.push_back(zone); });
+    for (const auto &event : word) {
+      monitor.feed(event.first, event.second);
+    }
+    monitor.finish();
+    BOOST_CHECK_EQUAL(monitor.size(), word.size());
+    checkSame(result, expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(feedBatch) {
+  const auto word = makeRandomTimedWord();
+  const CompiledPattern pattern = makePattern(true);
+  AnsVec<Zone> expected;
+  monaaDollar(WordSlice<OnlineMonitor::Event>(word.data(), word.size()), pattern, expected);
+
+  std::vector<Zone> result;
+  OnlineMonitor monitor(pattern, [&result](const Zone &zone) { result.push_back(zone); });
+  RandomTimedWord lengths(7);
+  for (std::size_t i = 0; i < word.size();) {
+    const std::size_t length = std::min<std::size_t>((lengths.nextInt() >> 16) % 20, word.size() - i);
+    monitor.feedBatch(std::span<const OnlineMonitor::Event>(word.data() + i, length));
+    i += length;
+  }
+  monitor.finish();
+  checkSame(result, expected);
+}
+
+BOOST_AUTO_TEST_CASE(checkpointRestore) {
+  const auto word = makeRandomTimedWord();
+  const CompiledPattern pattern = makePattern(true);
+  AnsVec<Zone> expected;
+  monaaDollar(WordSlice<OnlineMonitor::Event>(word.data(), word.size()), pattern, expected);
+
+  for (const std::size_t split : {0, 1, 2, 1000, 1501, 2999, 3000}) {
+    std::vector<Zone> result;
+    const auto callback = [&result](const Zone &zone) { result.push_back(zone); };
+    std::stringstream snapshot;
+    {
+      OnlineMonitor monitor(pattern, callback);
+      monitor.feedBatch(std::span<const OnlineMonitor::Event>(word.data(), split));
+      monitor.checkpoint(snapshot);
+    }
+    OnlineMonitor monitor(pattern, callback);
+    monitor.restore(snapshot);
+    BOOST_CHECK_EQUAL(monitor.size(), split);
+    for (std::size_t i = split; i < word.size(); ++i) {
+      monitor.feed(word[i].first, word[i].second);
+    }
+    monitor.finish();
+    checkSame(result, expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(restoreAnotherPattern) {
+  const auto word = makeRandomTimedWord();
+  std::stringstream snapshot;
+  OnlineMonitor monitor(makePattern(true), [](const Zone &) {});
+  monitor.feedBatch(std::span<const OnlineMonitor::Event>(word.data(), 100));
+  monitor.checkpoint(snapshot);
+
+  TimedAutomaton TA;
+  TA.states = {std::make_shared<TAState>(), std::make_shared<TAState>(true)};
+  TA.initialStates = {TA.states[0]};
+  TA.states[0]->next['a'].push_back({TA.states[1].get(), {}, {}});
+  OnlineMonitor another(CompiledPattern(TA, CompiledPattern::Mode::event), [](const Zone &) {});
+  BOOST_CHECK_THROW(another.restore(snapshot), std::runtime_error);
+
+  std::stringstream truncated(snapshot.str().substr(0, 20));
+  BOOST_CHECK_THROW(monitor.restore(truncated), std::runtime_error);
+
+  // The version of the format follows the 8-byte magic.
+  std::string versioned = snapshot.str();
+  versioned[8]++;
+  std::stringstream anotherVersion(versioned);
+  BOOST_CHECK_THROW(monitor.restore(anotherVersion), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(restoreBrokenKeepsMonitor) {
+  const auto word = makeRandomTimedWord();
+  const CompiledPattern pattern = makePattern(true);
+  AnsVec<Zone> expected;
+  monaaDollar(WordSlice<OnlineMonitor::Event>(word.data(), word.size()), pattern, expected);
+
+  std::vector<Zone> result;
+  OnlineMonitor monitor(pattern, [&result](const Zone &zone) { result.push_back(zone); });
+  monitor.feedBatch(std::span<const OnlineMonitor::Event>(word.data(), 1000));
+  std::stringstream snapshot;
+  monitor.checkpoint(snapshot);
+
+  // The starting position follows the magic, the version, the fingerprint, the phase, and the flag of the end. A
+  // starting position before the buffered window is rejected in any phase.
+  std::string broken = snapshot.str();
+  const std::uint64_t zero = 0;
+  std::memcpy(broken.data() + 22, &zero, sizeof(zero));
+  std::stringstream brokenSnapshot(broken);
+  BOOST_CHECK_THROW(monitor.restore(brokenSnapshot), std::runtime_error);
+  std::stringstream truncated(snapshot.str().substr(0, snapshot.str().size() - 1));
+  BOOST_CHECK_THROW(monitor.restore(truncated), std::runtime_error);
+
+  // The rejected snapshots did not modify the monitor.
+  BOOST_CHECK_EQUAL(monitor.size(), 1000);
+  for (std::size_t i = 1000; i < word.size(); ++i) {
+    monitor.feed(word[i].first, word[i].second);
+  }
+  monitor.finish();
+  checkSame(result, expected);
+}
+
+BOOST_AUTO_TEST_CASE(restoreSameShapeAnotherGuard) {
+  // The patterns differ only in a constant of a guard
+  const CompiledPattern pattern = makePattern(true);
+  const CompiledPattern another = makePattern(true, 2);
+  BOOST_REQUIRE_EQUAL(pattern.automaton.stateSize(), another.automaton.stateSize());
+  BOOST_REQUIRE_EQUAL(pattern.automaton.clockSize(), another.automaton.clockSize());
+  BOOST_CHECK_NE(fingerprint(pattern), fingerprint(another));
+
+  const auto word = makeRandomTimedWord();
+  std::stringstream snapshot;
+  OnlineMonitor monitor(pattern, [](const Zone &) {});
+  monitor.feedBatch(std::span<const OnlineMonitor::Event>(word.data(), 100));
+  monitor.checkpoint(snapshot);
+  OnlineMonitor anotherMonitor(another, [](const Zone &) {});
+  BOOST_CHECK_THROW(anotherMonitor.restore(snapshot), std::runtime_error);
+  snapshot.seekg(0);
+  OnlineMonitor sameMonitor(pattern, [](const Zone &) {});
+  BOOST_CHECK_NO_THROW(sameMonitor.restore(snapshot));
+}
+
+BOOST_AUTO_TEST_CASE(rejectSignalMode) {
+  TimedAutomaton TA;
+  TA.states = {std::make_shared<TAState>(), std::make_shared<TAState>(true)};
+  TA.initialStates = {TA.states[0]};
+  TA.states[0]->next['a'].push_back({TA.states[1].get(), {}, {}});
+  BOOST_CHECK_THROW(OnlineMonitor(CompiledPattern(TA, CompiledPattern::Mode::signal), [](const Zone &) {}),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
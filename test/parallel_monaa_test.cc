@@ -0,0 +1,125 @@
+#include <cmath>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/parallel_monaa.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(parallelMonaaTest)
+
+struct ParallelMonaaFixture {
+  std::vector<std::pair<Alphabet, double>> word = makeRandomTimedWord();
+  TimedAutomaton TA;
+
+  void check(const CompiledPattern &pattern) {
+    BOOST_TEST(std::isfinite(pattern.duration.getMax()));
+    AnsVec<Zone> expected;
+    if (pattern.mode == CompiledPattern::Mode::signal) {
+      monaa(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, expected);
+    } else {
+      monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, expected);
+    }
+    BOOST_TEST(expected.size() > 0);
+
+    AnsVec<Zone> result;
+    parallelMonaa(word, pattern, result, 4);
+    BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+    auto it = expected.begin();
+    for (const Zone &zone : result) {
+      BOOST_TEST(bool(zone == *it++));
+    }
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(event, ParallelMonaaFixture) {
+  makeReferenceTA(TA, '$');
+  check(CompiledPattern(TA, CompiledPattern::Mode::event));
+}
+
+BOOST_FIXTURE_TEST_CASE(signal, ParallelMonaaFixture) {
+  makeReferenceTA(TA, 'c');
+  check(CompiledPattern(TA, CompiledPattern::Mode::signal));
+}
+
+BOOST_FIXTURE_TEST_CASE(multiPattern, ParallelMonaaFixture) {
+  // A compiled pattern has its own copy of the automaton.
+  makeReferenceTA(TA, '$');
+  const CompiledPattern eventPattern(TA, CompiledPattern::Mode::event);
+  TA.states[2]->next['$'].front().guard = {TimedAutomaton::X(0) < 1};
+  const CompiledPattern shortPattern(TA, CompiledPattern::Mode::event);
+
+  std::vector<AnsVec<Zone>> result(2);
+  multiMonaa(word, {&eventPattern, &shortPattern}, result, 2);
+  for (std::size_t p = 0; p < 2; ++p) {
+    AnsVec<Zone> expected;
+    monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), p == 0 ? eventPattern : shortPattern,
+                expected);
+    BOOST_REQUIRE_EQUAL(result[p].size(), expected.size());
+    auto it = expected.begin();
+    for (const Zone &zone : result[p]) {
+      BOOST_TEST(bool(zone == *it++));
+    }
+  }
+  BOOST_TEST(result[0].size() > result[1].size());
+}
+
+BOOST_FIXTURE_TEST_CASE(mergedCounters, ParallelMonaaFixture) {
+  makeReferenceTA(TA, '$');
+  const CompiledPattern pattern(TA, CompiledPattern::Mode::event);
+  AnsVec<Zone> expected;
+  MatchCounters expectedCounters;
+  monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, expected, &expectedCounters);
+
+  // Each chunk is counted in its own counters, and they are merged after the matching.
+  AnsVec<Zone> result;
+  MatchCounters counters;
+  parallelMonaa(word, pattern, result, 4, &counters);
+  BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+  BOOST_CHECK_EQUAL(counters.events, word.size());
+  BOOST_TEST(counters.sundayShifts > 0);
+  BOOST_TEST(counters.kmpShifts > 0);
+  BOOST_TEST(counters.configurations >= expected.size());
+  BOOST_CHECK_EQUAL(counters.peakConfigurations, expectedCounters.peakConfigurations);
+  BOOST_CHECK_EQUAL(counters.peakWindow, expectedCounters.peakWindow);
+
+  std::vector<AnsVec<Zone>> multiResult(2);
+  MatchCounters multiCounters;
+  multiMonaa(word, {&pattern, &pattern}, multiResult, 4, &multiCounters);
+  BOOST_CHECK_EQUAL(multiCounters.events, word.size());
+  BOOST_CHECK_EQUAL(multiCounters.configurations, 2 * counters.configurations);
+}
+
+BOOST_FIXTURE_TEST_CASE(multiPatternSparseEndChars, ParallelMonaaFixture) {
+  // The end character 'b' of the first pattern is only in a few blocks, and the end character 'd' of the second one
+  // is not in the timed word at all.
+  word = makeRandomTimedWord(20 * EndCharBlocks::blockSize);
+  for (std::size_t n = 0; n < word.size(); ++n) {
+    if (word[n].first == 'b' && (n / EndCharBlocks::blockSize) % 5 != 1) {
+      word[n].first = 'c';
+    }
+  }
+  makeReferenceTA(TA, '$');
+  const CompiledPattern sparsePattern(TA, CompiledPattern::Mode::event);
+  TA.states[1]->next['d'] = std::move(TA.states[1]->next['b']);
+  TA.states[1]->next.erase('b');
+  const CompiledPattern absentPattern(TA, CompiledPattern::Mode::event);
+
+  const EndCharBlocks blocks(word);
+  BOOST_CHECK_EQUAL(blocks.startRanges(sparsePattern).size(), 4);
+  BOOST_TEST(blocks.startRanges(absentPattern).empty());
+
+  for (std::size_t threadSize : {1, 4}) {
+    std::vector<AnsVec<Zone>> result(2);
+    multiMonaa(word, {&sparsePattern, &absentPattern}, result, threadSize);
+    AnsVec<Zone> expected;
+    monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), sparsePattern, expected);
+    BOOST_TEST(expected.size() > 0);
+    BOOST_REQUIRE_EQUAL(result[0].size(), expected.size());
+    auto it = expected.begin();
+    for (const Zone &zone : result[0]) {
+      BOOST_TEST(bool(zone == *it++));
+    }
+    BOOST_TEST(result[1].size() == 0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,64 @@
+#include <cstdio>
+#include <stdexcept>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/monaa.hh"
+#include "../libmonaa/pipeline.hh"
+#include "reference_pattern.hh"
+
+BOOST_AUTO_TEST_SUITE(pipelineTest)
+
+BOOST_AUTO_TEST_CASE(sameAsMonaaDollar) {
+  const auto word = makeRandomTimedWord();
+  FILE *file = std::tmpfile();
+  BOOST_REQUIRE(file);
+  for (const auto &[c, t] : word) {
+    fprintf(file, "%c %.17g\n", c, t);
+  }
+  std::rewind(file);
+
+  TimedAutomaton TA;
+  makeReferenceTA(TA, '$');
+  const CompiledPattern pattern(TA, CompiledPattern::Mode::event);
+
+  AnsVec<Zone> expected;
+  monaaDollar(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), pattern, expected);
+  BOOST_TEST(expected.size() > 0);
+
+  std::vector<AnsVec<Zone>> result(1);
+  // A small capacity so that the threads wait for each other
+  pipelineMonaa(
+      file, false, result,
+      [&](WordRingDeque w, std::vector<AnsRing> &ans) { monaaDollar(std::move(w), pattern, ans.front()); }, 4);
+  std::fclose(file);
+
+  BOOST_REQUIRE_EQUAL(result.front().size(), expected.size());
+  auto it = expected.begin();
+  for (const Zone &zone : result.front()) {
+    BOOST_TEST(bool(zone == *it++));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(failWithLiveInput) {
+  // A live input whose end does not come while the matching runs
+  int fds[2];
+  BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+  FILE *file = fdopen(fds[0], "r");
+  BOOST_REQUIRE(file);
+  const char events[] = "a 0.5\nb 1.0\n";
+  BOOST_REQUIRE_EQUAL(write(fds[1], events, sizeof(events) - 1), ssize_t(sizeof(events) - 1));
+
+  std::vector<AnsVec<Zone>> result(1);
+  // The matching fails while the reader is blocked in reading the next event, and we must not wait for it.
+  BOOST_CHECK_THROW(pipelineMonaa(file, false, result,
+                                  [](WordRingDeque w, std::vector<AnsRing> &) {
+                                    BOOST_REQUIRE(w.fetch(0));
+                                    throw std::runtime_error("failure in the matching");
+                                  }),
+                    std::runtime_error);
+  // The detached reader exits at the end of the input. We do not close file because it may still be read.
+  close(fds[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
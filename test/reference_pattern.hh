@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../libmonaa/timed_automaton.hh"
+
+/*
+  @brief The pseudo random timed word and the timed automaton shared by the tests comparing a matching with monaa or
+  monaaDollar
+ */
+
+//! @brief A pseudo random timed word over {a, b, c} generated by a linear congruential generator
+class RandomTimedWord {
+public:
+  explicit RandomTimedWord(unsigned int seed = 1) : seed(seed) {}
+
+  //! @brief Advance the generator and return its new state
+  unsigned int nextInt() {
+    seed = seed * 1103515245 + 12345;
+    return seed;
+  }
+
+  //! @brief Returns the next event. Its timestamp is later than the previous one by 0.1, 0.2, ..., or 1.0.
+  std::pair<Alphabet, double> next() {
+    nextInt();
+    t += 0.1 * ((seed >> 16) % 10 + 1);
+    return {"abc"[(seed >> 8) % 3], t};
+  }
+
+  //! @brief Returns the state of the generator after the last event, e.g., to pick the key of the event
+  unsigned int state() const { return seed; }
+
+private:
+  unsigned int seed;
+  double t = 0;
+};
+
+//! @brief Returns the first size events of RandomTimedWord with the seed 1
+inline std::vector<std::pair<Alphabet, double>> makeRandomTimedWord(std::size_t size = 3000) {
+  RandomTimedWord generator;
+  std::vector<std::pair<Alphabet, double>> word;
+  word.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    word.push_back(generator.next());
+  }
+  return word;
+}
+
+/*
+  @brief Make the timed automaton of a b last, where the clock x is reset at a and the guards are x < 1 at a,
+  x < bBound at b, and x < lastBound at last.
+
+  If last is '$', the automaton is for the event mode. The states are TA.states[0], ..., TA.states[3] along the path.
+ */
+inline void makeReferenceTA(TimedAutomaton &TA, Alphabet last, int bBound = 2, int lastBound = 3) {
+  TA.states.resize(4);
+  for (auto &state : TA.states) {
+    state = std::make_shared<TAState>();
+  }
+  TA.initialStates = {TA.states[0]};
+  TA.states[3]->isMatch = true;
+  TA.states[0]->next['a'].push_back({TA.states[1].get(), {0}, {TimedAutomaton::X(0) < 1}});
+  TA.states[1]->next['b'].push_back({TA.states[2].get(), {}, {TimedAutomaton::X(0) < bBound}});
+  TA.states[2]->next[last].push_back({TA.states[3].get(), {}, {TimedAutomaton::X(0) < lastBound}});
+  TA.maxConstraints = {std::max(bBound, lastBound)};
+}
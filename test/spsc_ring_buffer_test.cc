@@ -0,0 +1,41 @@
+#include <thread>
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/spsc_ring_buffer.hh"
+
+BOOST_AUTO_TEST_SUITE(spscRingBufferTest)
+
+BOOST_AUTO_TEST_CASE(inOrder) {
+  // The capacity is smaller than the values so that both sides wait.
+  SPSCRingBuffer<int> ring(5);
+  std::thread producer([&] {
+    for (int i = 0; i < 100000; ++i) {
+      ring.push(i);
+    }
+    ring.close();
+  });
+  int value;
+  int expected = 0;
+  while (ring.pop(value)) {
+    BOOST_REQUIRE_EQUAL(value, expected++);
+  }
+  producer.join();
+  BOOST_CHECK_EQUAL(expected, 100000);
+}
+
+BOOST_AUTO_TEST_CASE(closeByConsumer) {
+  SPSCRingBuffer<int> ring(2);
+  std::thread producer([&] {
+    int i = 0;
+    while (ring.push(i++)) {
+    }
+  });
+  int value;
+  BOOST_CHECK(ring.pop(value));
+  BOOST_CHECK_EQUAL(value, 0);
+  // The producer waiting for the space stops.
+  ring.close();
+  producer.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
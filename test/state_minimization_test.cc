@@ -0,0 +1,67 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../libmonaa/timed_automaton.hh"
+#include "../libmonaa/state_minimization.hh"
+
+BOOST_AUTO_TEST_SUITE(stateMinimizationTests)
+
+class TAFixture {
+public:
+  TimedAutomaton TA;
+  TAFixture() {
+    TA.states.resize(5);
+    for (auto &state: TA.states) {
+      state = std::make_shared<TAState>();
+    }
+
+    TA.initialStates = {TA.states[0], TA.states[1]};
+
+    TA.states[0]->isMatch = false;
+    TA.states[1]->isMatch = false;
+    TA.states[2]->isMatch = false;
+    TA.states[3]->isMatch = true;
+    TA.states[4]->isMatch = true;
+
+    // Transitions
+    // 1 and 2 are bisimilar, and so are 3 and 4
+    TA.states[0]->next['a'].push_back({TA.states[1].get(), {0}, {}});
+    TA.states[0]->next['a'].push_back({TA.states[2].get(), {0}, {}});
+    TA.states[1]->next['b'].push_back({TA.states[3].get(), {}, {{TimedAutomaton::X(0) < 1}}});
+    TA.states[2]->next['b'].push_back({TA.states[4].get(), {}, {{TimedAutomaton::X(0) < 1}}});
+
+    TA.maxConstraints = {1};
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE( minimizeStatesTest, TAFixture )
+{
+  const StateMinimization result = minimizeStates(TA);
+
+  BOOST_CHECK_EQUAL(result.before, 5);
+  BOOST_CHECK_EQUAL(result.after, 3);
+  BOOST_REQUIRE_EQUAL(TA.stateSize(), 3);
+  BOOST_REQUIRE_EQUAL(TA.initialStates.size(), 2);
+  BOOST_CHECK_EQUAL(TA.initialStates[0], TA.states[0]);
+  BOOST_CHECK_EQUAL(TA.initialStates[1], TA.states[1]);
+  BOOST_REQUIRE_EQUAL(TA.states[0]->next['a'].size(), 1);
+  BOOST_CHECK_EQUAL(TA.states[0]->next['a'].front().target, TA.states[1].get());
+  BOOST_CHECK_EQUAL(TA.states[1]->next['b'].front().target, TA.states[2].get());
+  BOOST_CHECK(TA.states[2]->isMatch);
+
+  BOOST_CHECK(TA.isMember({{'a', 0.5}, {'b', 1.2}}));
+  BOOST_CHECK(!TA.isMember({{'a', 0.5}, {'b', 1.8}}));
+}
+
+BOOST_FIXTURE_TEST_CASE( differentGuardTest, TAFixture )
+{
+  TA.states[2]->next['b'].front().guard.front().c = 2;
+  const StateMinimization result = minimizeStates(TA);
+
+  // Only 3 and 4 are merged
+  BOOST_CHECK_EQUAL(result.before, 5);
+  BOOST_CHECK_EQUAL(result.after, 4);
+  BOOST_CHECK_EQUAL(TA.states[0]->next['a'].size(), 2);
+  BOOST_CHECK_EQUAL(TA.states[1]->next['b'].front().target, TA.states[2]->next['b'].front().target);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -51,4 +51,61 @@ BOOST_FIXTURE_TEST_CASE( sundaySkipValueTest, TAFixture )
   BOOST_CHECK_EQUAL(beta['d'], 3);
 }
 
+BOOST_FIXTURE_TEST_CASE( qGramSkipValueTest, TAFixture )
+{
+  SundaySkipValue beta(TA);
+
+  BOOST_TEST(beta.useQGram());
+  BOOST_CHECK_EQUAL(beta('c', 'a'), 1);
+  BOOST_CHECK_EQUAL(beta('a', 'c'), 2);
+  BOOST_CHECK_EQUAL(beta('a', 'a'), 3);
+  BOOST_CHECK_EQUAL(beta('d', 'a'), 3);
+  BOOST_CHECK_EQUAL(beta('d', 'd'), 4);
+  // The q-gram skip value is never smaller than the single-character one
+  for (char a = 1; a < CHAR_MAX; a++) {
+    for (char b = 1; b < CHAR_MAX; b++) {
+      BOOST_TEST(beta(a, b) >= beta[a]);
+    }
+  }
+  BOOST_TEST(beta.getExpectedShift() > 2.0);
+
+  // The bytes not in the pattern, including 127 and the ones above 127, are in range of the tables
+  for (int c : {0, CHAR_MAX, CHAR_MAX + 1, UCHAR_MAX}) {
+    const auto byte = static_cast<Alphabet>(c);
+    BOOST_CHECK_EQUAL(beta[byte], 3);
+    BOOST_CHECK_EQUAL(beta(byte, byte), 4);
+    BOOST_CHECK_EQUAL(beta(byte, 'a'), 3);
+    BOOST_CHECK_EQUAL(beta('a', byte), 4);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE( findEndCharTest, TAFixture )
+{
+  SundaySkipValue beta(TA);
+
+  BOOST_TEST(beta.isEndChar('c'));
+  BOOST_TEST(!beta.isEndChar('a'));
+  BOOST_TEST(!beta.isEndChar(0));
+
+  // The hit is beyond the first block of 64 events
+  std::vector<Alphabet> column(100, 'a');
+  column[70] = 'c';
+  column[90] = 'c';
+  BOOST_CHECK_EQUAL(beta.findEndChar(column.data(), column.data() + column.size()) - column.data(), 70);
+  BOOST_CHECK_EQUAL(beta.findEndChar(column.data() + 71, column.data() + column.size()) - column.data(), 90);
+  BOOST_CHECK_EQUAL(beta.findEndChar(column.data(), column.data() + 70) - column.data(), 70);
+
+  // The block kernel agrees with the label-by-label scan for every byte and every tail length
+  std::vector<Alphabet> bytes;
+  for (int k = 0; k < 3 * 256; k++) {
+    bytes.push_back(static_cast<Alphabet>((k * 37) % 256));
+  }
+  for (std::size_t first = 0; first < 40; first++) {
+    for (std::size_t last = first; last < bytes.size(); last += 13) {
+      const auto scalar = beta.findEndChar([&bytes](std::size_t n) { return bytes[n]; }, first, last);
+      BOOST_CHECK_EQUAL(beta.findEndChar(bytes.data() + first, bytes.data() + last) - bytes.data(), scalar);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
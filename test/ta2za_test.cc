@@ -62,7 +62,9 @@ BOOST_FIXTURE_TEST_CASE( ta2zaTest, ZAFixture )
   BOOST_TEST (ZA.stateSize() == 8);
   BOOST_TEST (ZA.initialStates.size() == 1);
   for (std::size_t i = 0; i < ZA.stateSize(); i++) {
-    BOOST_TEST (ZA.states[i]->next['a'].size() == expectedDegrees[i]);
+    BOOST_TEST (std::count_if(ZA.states[i]->next.begin(), ZA.states[i]->next.end(), [](const ZATransition &edge) {
+          return edge.c == 'a';
+        }) == expectedDegrees[i]);
   }
   BOOST_CHECK_EQUAL(std::count_if(ZA.states.begin(), ZA.states.end(), [](std::shared_ptr<ZAState> state) {
         return state->isMatch;
@@ -98,4 +98,42 @@ BOOST_AUTO_TEST_CASE(timedFJSTorque) {
   BOOST_CHECK_CLOSE(ansZone(2, 1).first, 1.00988, 1e-6);
 }
 
+BOOST_AUTO_TEST_CASE(timedFJSEpsilonReset) {
+  // Two epsilon transitions, each more than 1 after the previous reset, and
+  // then 'a' within 1 after the last epsilon transition.
+  TimedAutomaton TA;
+  TA.states.resize(4);
+  for (auto &state: TA.states) {
+    state = std::make_shared<TAState>();
+  }
+
+  TA.initialStates = {TA.states[0]};
+
+  TA.states[0]->isMatch = false;
+  TA.states[1]->isMatch = false;
+  TA.states[2]->isMatch = false;
+  TA.states[3]->isMatch = true;
+
+  // Transitions
+  TA.states[0]->next[0].push_back({TA.states[1].get(), {0}, {{TimedAutomaton::X(0) > 1}}});
+  TA.states[1]->next[0].push_back({TA.states[2].get(), {0}, {{TimedAutomaton::X(0) > 1}}});
+  TA.states[2]->next['a'].push_back({TA.states[3].get(), {}, {{TimedAutomaton::X(0) < 1}}});
+
+  TA.maxConstraints = {1};
+
+  std::vector<std::pair<Alphabet, double>> word = {{'a', 5}};
+  AnsVec<Zone> ans;
+  monaa(WordSlice<std::pair<Alphabet, double>>(word.data(), word.size()), TA, ans);
+  BOOST_CHECK_EQUAL(ans.size(), 1);
+
+  // The clock is reset at each epsilon transition, so the duration is more than 2.
+  const auto ansZone = ans.begin()->value;
+  BOOST_TEST(bool(ansZone(0, 1) == Bounds{0, true}));
+  BOOST_TEST(bool(ansZone(1, 0) == Bounds{3, false}));
+  BOOST_TEST(bool(ansZone(0, 2) == Bounds{-2, false}));
+  BOOST_TEST(bool(ansZone(2, 0) == Bounds{5, true}));
+  BOOST_TEST(bool(ansZone(1, 2) == Bounds{-2, false}));
+  BOOST_TEST(bool(ansZone(2, 1) == Bounds{5, true}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,6 @@
 
 #include <boost/test/unit_test.hpp>
+#include <chrono>
 
 #include "../libmonaa/zone_automaton.hh"
 #include "../libmonaa/ta2za.hh"
@@ -51,8 +52,8 @@ BOOST_AUTO_TEST_CASE(removeDeadStatesTest)
   ZA.states[2]->isMatch = true;
 
   // Transitions
-  ZA.states[0]->next['a'].push_back(ZA.states[1]);
-  ZA.states[0]->next['a'].push_back(ZA.states[2]);
+  ZA.states[0]->next.push_back({'a', 1});
+  ZA.states[0]->next.push_back({'a', 2});
 
   // Run
   ZA.removeDeadStates();
@@ -60,6 +61,44 @@ BOOST_AUTO_TEST_CASE(removeDeadStatesTest)
   // Comparison
   BOOST_TEST (ZA.stateSize() == 2);
   BOOST_TEST (ZA.initialStates.size() == 1);
+  // The transition to the removed state is removed, and the target of the other is renumbered
+  BOOST_REQUIRE_EQUAL (ZA.states[0]->next.size(), 1);
+  BOOST_TEST (ZA.states[0]->next.front().target == 1);
+  BOOST_TEST (ZA.states[1]->isMatch);
+}
+
+BOOST_AUTO_TEST_CASE(removeDeadStatesLargeTest)
+{
+  // Input: a chain of 10^5 states with back edges, a dead end, and an unreachable state
+  constexpr std::size_t size = 100000;
+  ZoneAutomaton ZA;
+  ZA.states.resize(size + 2);
+  for (auto &state: ZA.states) {
+    state = std::make_shared<ZAState>();
+  }
+  ZA.initialStates.push_back(ZA.states[0]);
+  ZA.states[size - 1]->isMatch = true;
+  for (std::size_t i = 0; i + 1 < size; ++i) {
+    ZA.states[i]->next.push_back({'a', i + 1});
+    ZA.states[i + 1]->next.push_back({'b', i / 2});
+    ZA.states[i + 1]->next.push_back({'c', i});
+  }
+  // dead end
+  ZA.states[size / 2]->next.push_back({'d', size});
+  // unreachable from the initial state
+  ZA.states[size + 1]->next.push_back({'a', size - 1});
+
+  // Run
+  const auto begin = std::chrono::steady_clock::now();
+  ZA.removeDeadStates();
+  const auto end = std::chrono::steady_clock::now();
+  BOOST_TEST_MESSAGE("removeDeadStates with 10^5 states: "
+                     << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms");
+
+  // Comparison
+  BOOST_TEST (ZA.stateSize() == size);
+  BOOST_TEST (ZA.initialStates.size() == 1);
+  BOOST_TEST (ZA.states.front() == ZA.initialStates.front());
 }
 
 BOOST_AUTO_TEST_CASE(epsilonClosureTest)
@@ -77,15 +116,15 @@ BOOST_AUTO_TEST_CASE(epsilonClosureTest)
   ZA.states[2]->isMatch = true;
 
   // Transitions
-  ZA.states[0]->next[0].push_back(ZA.states[0]);
-  ZA.states[0]->next[0].push_back(ZA.states[1]);
-  ZA.states[0]->next['a'].push_back(ZA.states[2]);
+  ZA.states[0]->next.push_back({0, 0});
+  ZA.states[0]->next.push_back({0, 1});
+  ZA.states[0]->next.push_back({'a', 2});
 
-  std::unordered_set<std::shared_ptr<ZAState>> closure;
-  closure.insert(ZA.states[0]);
+  std::unordered_set<std::size_t> closure;
+  closure.insert(0);
 
   // Run
-  epsilonClosure(closure);
+  epsilonClosure(ZA, closure);
 
   // Comparison
   BOOST_TEST (closure.size() == 2);
@@ -39,4 +39,40 @@ BOOST_AUTO_TEST_CASE(makeGuard) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(hash) {
+  Zone zone = Zone::zero(3);
+  zone.elapse();
+  Zone another = zone;
+  // (0, 0) is ignored in the comparison
+  another.value(0, 0) = {2, false};
+  BOOST_TEST(bool(zone == another));
+  BOOST_CHECK_EQUAL(zone.hash(), another.hash());
+
+  another.tighten(0, -1, {1, true});
+  BOOST_TEST(!bool(zone == another));
+  BOOST_TEST(zone.hash() != another.hash());
+}
+
+BOOST_AUTO_TEST_CASE(extrapolate) {
+  Zone zone = Zone::zero(3);
+  zone.elapse();
+  // x0 = x1 >= 10
+  zone.tighten(-1, 0, {-10, true});
+  zone.canonize();
+  zone.extrapolate({5, 5}, {5, 20});
+  zone.canonize();
+
+  static constexpr Bounds infinity =
+      Bounds(std::numeric_limits<double>::infinity(), false);
+  // x0 > 5 since 10 is greater than U[x0]
+  BOOST_TEST(bool(zone.value(0, 1) == Bounds(-5, false)));
+  // x1 >= 10 since 10 is not greater than U[x1]
+  BOOST_TEST(bool(zone.value(0, 2) == Bounds(-10, true)));
+  // The upper bounds and the differences are dropped since x0 and x1 are greater than L
+  BOOST_TEST(bool(zone.value(1, 0) == infinity));
+  BOOST_TEST(bool(zone.value(2, 0) == infinity));
+  BOOST_TEST(bool(zone.value(1, 2) == infinity));
+  BOOST_TEST(bool(zone.value(2, 1) == infinity));
+}
+
 BOOST_AUTO_TEST_SUITE_END()